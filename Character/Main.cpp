@@ -23,6 +23,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/PawnNoiseEmitterComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Engine/AssetManager.h"
 #include "Engine/World.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -147,6 +148,7 @@ AMain::AMain()
 
 	// default delay upon death (to allow showing death screen UI, music, etc)
 	RespawnDelay = 5.0f;
+	bHasRespawnTransform = false;
 
 	MaxStamina = 100.0f;
 	Stamina = MaxStamina;
@@ -272,6 +274,11 @@ void AMain::BeginPlay()
 	// when the player spawns in, they have no items equipped. cache these (so if a player unequips an item we can reset back to base skin meshes)
 	for (auto& PlayerMesh : MainMeshes)
 	{ NakedMeshes.Add(PlayerMesh.Key, PlayerMesh.Value->SkeletalMesh); }
+
+	// cache pre-death state for fast respawns
+	MeshRelativeTransform = GetMesh()->GetRelativeTransform();
+	MeshCollisionEnabled = GetMesh()->GetCollisionEnabled();
+	CapsuleCollisionEnabled = GetCapsuleComponent()->GetCollisionEnabled();
 }
 
 
@@ -298,7 +305,13 @@ void AMain::OnRep_LootSource()
 	if (AMainPlayerController* PlayerController = Cast<AMainPlayerController>(GetController()))
 	{
 		if (LootSource)
-		{ PlayerController->ShowLootMenu(LootSource); }
+		{
+			// the loot menu shows both inventories
+			LootSource->PrefetchPresentationAssets();
+			PlayerInventory->PrefetchPresentationAssets();
+
+			PlayerController->ShowLootMenu(LootSource);
+		}
 
 		else
 		{ PlayerController->HideLootMenu(); }
@@ -1041,13 +1054,10 @@ void AMain::LootItem(class UItem* ItemToGive)
 {
 	if (PlayerInventory && LootSource && ItemToGive && LootSource->HasItem(ItemToGive->GetClass(), ItemToGive->GetQuantity()))
 	{
-		const FItemAddResult AddResult = PlayerInventory->TryAddItem(ItemToGive);
-
-		// if successful, remove from source after adding to player inventory
-		if (AddResult.ActualAmountGiven > 0)
-		{ LootSource->ConsumeItem(ItemToGive, AddResult.ActualAmountGiven); }
+		// moves the stack straight across; removed from the source only as much as was added
+		const FItemAddResult AddResult = UInventoryComponent::TransferItem(LootSource, PlayerInventory, ItemToGive, ItemToGive->GetQuantity());
 
-		else
+		if (AddResult.ActualAmountGiven <= 0)
 		{
 			// notify player why they couldn't loot the item
 			if (AMainPlayerController* PlayerController = Cast<AMainPlayerController>(GetController()))
@@ -1057,6 +1067,25 @@ void AMain::LootItem(class UItem* ItemToGive)
 }
 
 
+void AMain::LootAllItems()
+{
+	if (PlayerInventory && LootSource)
+	{
+		for (const FItemAddResult& AddResult : UInventoryComponent::TransferAllItems(LootSource, PlayerInventory))
+		{
+			// notify player of the first thing they couldn't take
+			if (AddResult.Result != EItemAddResult::IAR_AllItemsAdded)
+			{
+				if (AMainPlayerController* PlayerController = Cast<AMainPlayerController>(GetController()))
+				{ PlayerController->ClientShowNotification(AddResult.ErrorText); }
+
+				break;
+			}
+		}
+	}
+}
+
+
 bool AMain::EquipItem(class UEquippableItem* Item)
 {
 	for (int32 i = 0; i < Item->Slots.Num(); ++i)
@@ -1075,14 +1104,10 @@ bool AMain::UnequipItem(class UEquippableItem* Item)
 	{
 		for (int32 i = 0; i < Item->Slots.Num(); ++i)
 		{
-			if (EquippedItems.Contains(Item->Slots[i]))
+			if (FindEquippedItem(Item->Slots[i]) == Item)
 			{
-				if (Item == *EquippedItems.Find(Item->Slots[i]))
-				{
-					EquippedItems.Remove(Item->Slots[i]);
-					OnEquippedItemsChanged.Broadcast(Item->Slots[i], nullptr);
-					
-				}
+				EquippedItems.Remove(Item->Slots[i]);
+				OnEquippedItemsChanged.Broadcast(Item->Slots[i], nullptr);
 			}
 		}
 
@@ -1094,15 +1119,66 @@ bool AMain::UnequipItem(class UEquippableItem* Item)
 
 
 void AMain::EquipGear(class UGearItem* Gear)
+{
+	// meshes and equip sound are soft references; gear that wasn't prefetched goes on once they've streamed in
+	if (!Gear->AreEquipAssetsLoaded())
+	{
+		const TSharedPtr<FStreamableHandle>* GearLoad = GearLoads.Find(Gear);
+
+		// first time: OnGearAssetsLoaded puts it on (it doesn't look at GearLoads for this gear, so a load that completes right away is fine)
+		if (!GearLoad)
+		{
+			TArray<FSoftObjectPath> EquipAssets;
+			Gear->GetEquipAssets(EquipAssets);
+
+			GearLoads.Add(Gear, UAssetManager::GetStreamableManager().RequestAsyncLoad(EquipAssets, FStreamableDelegate::CreateUObject(this, &AMain::OnGearAssetsLoaded, TWeakObjectPtr<UGearItem>(Gear))));
+			return;
+		}
+
+		// still streaming in
+		if (GearLoad->IsValid() && !(*GearLoad)->HasLoadCompleted())
+		{ return; }
+
+		// otherwise the load has already finished; anything still unresolved is missing, so go with what did resolve
+	}
+
+	ApplyGear(Gear);
+}
+
+
+void AMain::OnGearAssetsLoaded(TWeakObjectPtr<UGearItem> Gear)
+{
+	// drop loads for gear that no longer exists
+	for (auto It = GearLoads.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{ It.RemoveCurrent(); }
+	}
+
+	// only if it wasn't unequipped (or replaced) while loading
+	if (Gear.IsValid() && Gear->IsEquipped())
+	{ ApplyGear(Gear.Get()); }
+}
+
+
+void AMain::ApplyGear(class UGearItem* Gear)
 {
 	for (int32 i = 0; i < Gear->Meshes.Num(); ++i)
 	{
+		USkeletalMesh* LoadedMesh = Gear->Meshes[i].Get();
+
+		if (!LoadedMesh)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: couldn't load gear mesh %s"), *Gear->GetName(), *Gear->Meshes[i].ToString());
+			continue;
+		}
+
 		if (USkeletalMeshComponent* GearMesh = *MainMeshes.Find(Gear->Slots[i]))
-		{ GearMesh->SetSkeletalMesh(Gear->Meshes[i]); }
+		{ GearMesh->SetSkeletalMesh(LoadedMesh); }
 	}
 
-	if (Gear->EquipSound && bShouldPlayGearEquipUnequipSounds)
-	{ PlayGearEquipSFX(true, Gear->EquipSound); }
+	if (Gear->EquipSound.Get() && bShouldPlayGearEquipUnequipSounds)
+	{ PlayGearEquipSFX(true, Gear->EquipSound.Get()); }
 }
 
 
@@ -1259,7 +1335,7 @@ void AMain::UseItem(class UItem* Item)
 	if (Item)
 	{
 		// can't use an item you don't have
-		if (PlayerInventory && !PlayerInventory->FindItem(Item))
+		if (PlayerInventory && !PlayerInventory->HasItem(Item->GetClass()))
 		{ return; }
 
 		Item->Use(this);
@@ -1269,7 +1345,7 @@ void AMain::UseItem(class UItem* Item)
 
 void AMain::DropItem(class UItem* Item, const int32 Quantity)
 {
-	if (PlayerInventory && Item && PlayerInventory->FindItem(Item))
+	if (PlayerInventory && Item && PlayerInventory->HasItem(Item->GetClass()))
 	{
 		const int32 ItemQuantity = Item->GetQuantity();
 		const int32 DroppedQuantity = PlayerInventory->ConsumeItem(Item, Quantity);
@@ -1733,6 +1809,55 @@ void AMain::DeathEnd()
 }
 
 
+void AMain::SetRespawnTransform(const FTransform& NewRespawnTransform)
+{
+	RespawnTransform = NewRespawnTransform;
+	bHasRespawnTransform = true;
+}
+
+
+void AMain::ResetForRespawn()
+{
+	GetWorldTimerManager().ClearTimer(RespawnTimer);
+
+	// undo ragdoll
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	GetMesh()->SetRelativeTransform(MeshRelativeTransform);
+
+	// undo DeathEnd
+	GetMesh()->bPauseAnims = false;
+	GetMesh()->bNoSkeletonUpdate = false;
+	GetMesh()->SetCollisionEnabled(MeshCollisionEnabled);
+	GetCapsuleComponent()->SetCollisionEnabled(CapsuleCollisionEnabled);
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{ AnimInstance->StopAllMontages(0.f); }
+
+	// restore stats
+	Health = MaxHealth;
+	DelayedHealthReportingValue = MaxHealth;
+	DelayedHealthBarValue = MaxHealth;
+	Stamina = MaxStamina;
+	StaminaStatus = EStaminaStatus::ESS_Normal;
+
+	bAttacking = false;
+	bCanJump = true;
+	bCanMove = true;
+	bCanEvade = true;
+	bCanTakeDamage = true;
+	SetMovementStatus(EMovementStatus::EMS_Normal);
+
+	SetActorTransform(RespawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	GetCharacterMovement()->StopMovementImmediately();
+
+	if (AController* PlayerController = GetController())
+	{ PlayerController->SetControlRotation(RespawnTransform.Rotator()); }
+
+	OnFastRespawnBP();
+}
+
+
 void AMain::StartAttack()
 {
 	if (EquippedWeapon)
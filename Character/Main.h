@@ -328,6 +328,26 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
 	float RespawnDelay;
+
+	// where a fast (in-place) respawn puts the player; only valid once a checkpoint has set it
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Spawning")
+	FTransform RespawnTransform;
+
+	// false until SetRespawnTransform is called; until then, respawning always falls back to a full level reload
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Spawning")
+	bool bHasRespawnTransform;
+
+	/* must be called by the checkpoint Blueprint's rest event (alongside the spawn manager's ResetSpawnsForCheckpoint), with the
+	transform the player should respawn at. fast respawns are disabled until it has been called */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void SetRespawnTransform(const FTransform& NewRespawnTransform);
+
+	// undo death in place: un-ragdoll, restore stats and collision, and move to RespawnTransform
+	void ResetForRespawn();
+
+	// BP-side cleanup for a fast respawn (death screen, ragdoll-related state set up in BP, etc)
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnFastRespawnBP();
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unarmed")
 	float UnarmedLightAttackDamage;
@@ -621,6 +641,11 @@ protected:
 
 	virtual void Restart() override;
 
+	// mesh placement and collision before any ragdoll, restored on fast respawn
+	FTransform MeshRelativeTransform;
+	TEnumAsByte<ECollisionEnabled::Type> MeshCollisionEnabled;
+	TEnumAsByte<ECollisionEnabled::Type> CapsuleCollisionEnabled;
+
 	UPROPERTY(BlueprintReadOnly)
 	UInventoryComponent* LootSource;
 
@@ -755,6 +780,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Looting")
 	void LootItem(class UItem* ItemToGive);
 
+	// take everything from the loot source that fits
+	UFUNCTION(BlueprintCallable, Category = "Looting")
+	void LootAllItems();
+
 	// handle equipping an equippable item
 	bool EquipItem(class UEquippableItem* Item);
 	bool UnequipItem(class UEquippableItem* Item);
@@ -763,6 +792,15 @@ public:
 	void EquipGear(class UGearItem* Gear);
 	void UnequipGear(const EEquippableSlot Slot, class UGearItem* Gear);
 
+	/* loads requested for gear equipped before its meshes were prefetched. each gear's are requested only once; once a load has
+	completed, the gear is put on with whatever resolved */
+	TMap<TWeakObjectPtr<class UGearItem>, TSharedPtr<FStreamableHandle>> GearLoads;
+
+	void OnGearAssetsLoaded(TWeakObjectPtr<class UGearItem> Gear);
+
+	// sets the gear's (loaded) meshes and plays its equip sound
+	void ApplyGear(class UGearItem* Gear);
+
 	void EquipWeapon(class UWeaponItem* WeaponItem);
 	void UnequipWeapon();
 
@@ -783,10 +821,21 @@ public:
 	UFUNCTION(BlueprintPure)
 	class USkeletalMeshComponent* GetSlotSkeletalMeshComponent(const EEquippableSlot Slot);
 
-	// helper function; expose otherwise protected EquippedItems
+	// helper function; expose otherwise protected EquippedItems. copies the map - for Blueprint; native code should use the accessors below
 	UFUNCTION(BlueprintPure)
 	FORCEINLINE TMap<EEquippableSlot, UEquippableItem*> GetEquippedItems() const { return EquippedItems; }
 
+	// the item equipped in the given slot, if any
+	UFUNCTION(BlueprintPure, Category = "Items")
+	FORCEINLINE UEquippableItem* FindEquippedItem(const EEquippableSlot Slot) const
+	{
+		UEquippableItem* const* EquippedItem = EquippedItems.Find(Slot);
+		return EquippedItem ? *EquippedItem : nullptr;
+	}
+
+	// iterates (slot, item) pairs without copying EquippedItems
+	FORCEINLINE TMap<EEquippableSlot, UEquippableItem*>::TConstIterator CreateEquippedItemsIterator() const { return EquippedItems.CreateConstIterator(); }
+
 	UFUNCTION(BlueprintCallable, Category = "Weapons")
 	FORCEINLINE class AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
 
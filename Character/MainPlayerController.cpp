@@ -3,12 +3,15 @@
 
 #include "MainPlayerController.h"
 #include "../Character/Main.h"
+#include "../World/EnemySpawnManager.h"
+#include "../World/Pickup.h"
 #include "Blueprint/UserWidget.h"
+#include "EngineUtils.h"
 #include "Kismet/GameplayStatics.h"
 
 AMainPlayerController::AMainPlayerController()
 {
-
+	bUseFastRespawn = false;
 }
 
 
@@ -26,7 +29,43 @@ void AMainPlayerController::ClientShowNotification(const FText& Message)
 
 void AMainPlayerController::Respawn()
 {
+	if (bUseFastRespawn && FastRespawn())
+	{ return; }
+
 	UGameplayStatics::OpenLevel(this, FName(*GetWorld()->GetName()), false);
 }
 
 
+bool AMainPlayerController::FastRespawn()
+{
+	AMain* Main = Cast<AMain>(GetPawn());
+	AEnemySpawnManager* SpawnManager = AEnemySpawnManager::Get(this);
+
+	// nowhere to put the player until they've rested at a checkpoint; reload instead
+	if (!Main || !SpawnManager || !Main->bHasRespawnTransform)
+	{ return false; }
+
+	// same enemies a reload would bring back (everything not killed since the last rest)
+	SpawnManager->ResetSpawnsForRespawn();
+
+	ClearTransientActors();
+
+	Main->ResetForRespawn();
+
+	ShowInGameUI();
+
+	return true;
+}
+
+
+void AMainPlayerController::ClearTransientActors()
+{
+	for (TActorIterator<APickup> It(GetWorld()); It; ++It)
+	{
+		// placed pickups were loaded with the level; anything else was dropped at runtime
+		if (!It->HasAnyFlags(RF_WasLoaded))
+		{ It->Destroy(); }
+	}
+}
+
+
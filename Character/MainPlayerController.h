@@ -45,6 +45,18 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnHitPlayer();
 
+	// if true, Respawn resets the world in place (enemies, transient actors, player) instead of reloading the level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Controller")
+	bool bUseFastRespawn;
+
 	UFUNCTION(BlueprintCallable, Category = "Player Controller")
 	void Respawn();
+
+protected:
+
+	// returns false if the level isn't set up for it (no spawn manager) or the player hasn't rested yet, in which case the level is reloaded instead
+	bool FastRespawn();
+
+	// runtime-spawned actors a level reload would discard (dropped pickups)
+	void ClearTransientActors();
 };
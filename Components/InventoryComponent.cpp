@@ -2,13 +2,67 @@
 
 
 #include "../Components/InventoryComponent.h"
+#include "../Character/Main.h"
+#include "../Items/WeaponItem.h"
+#include "../Items/ShieldItem.h"
+#include "../Items/GearItem.h"
+#include "../Items/AccessoryItem.h"
+#include "Net/UnrealNetwork.h"
+#include "Algo/BinarySearch.h"
 
 #define LOCTEXT_NAMESPACE "Inventory"
 
 // sets default values for this component's properties
 UInventoryComponent::UInventoryComponent()
 {
+	CurrentWeight = 0.0f;
+	NextStackId = 1;
+	bChangesPending = false;
 
+	// ticks only to broadcast pending changes, after everything else this frame has had a chance to make its own
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	SetIsReplicatedByDefault(true);
+}
+
+
+void UInventoryComponent::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// set after properties are initialized, so a value copied from the archetype can't stick
+	StackList.OwningInventory = this;
+}
+
+
+void UInventoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// nothing was listening yet
+	PendingChanges.Reset();
+	bChangesPending = false;
+}
+
+
+void UInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SetComponentTickEnabled(false);
+
+	if (bChangesPending)
+	{
+		// listeners may change the inventory again; those changes go out next frame
+		const FInventoryChangeSummary ChangeSummary = MoveTemp(PendingChanges);
+		PendingChanges.Reset();
+		bChangesPending = false;
+
+		OnInventoryChanged.Broadcast(ChangeSummary);
+		OnInventoryUpdated.Broadcast();
+	}
 }
 
 
@@ -16,16 +70,196 @@ UInventoryComponent::UInventoryComponent()
 FItemAddResult UInventoryComponent::TryAddItem(class UItem* Item)
 {
 	// call internal add function
-	return TryAddItem_Internal(Item);
+	if (Item)
+	{ return TryAddItem_Internal(Item, Item->GetQuantity()); }
+
+	return FItemAddResult::AddedNone(-1, LOCTEXT("ErrorMessage", ""));
 }
 
 
 FItemAddResult UInventoryComponent::TryAddItemFromClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity)
 {
-	// construct new item, set quantity, call internal add function
-	UItem* Item = NewObject<UItem>(GetOwner(), ItemClass);
-	Item->SetQuantity(Quantity);
-	return TryAddItem_Internal(Item);
+	// validate against the class defaults; stacks are plain data, so no item object is constructed. more than a stack's worth spills into new stacks
+	if (const UItem* ItemDefaults = ItemClass ? ItemClass->GetDefaultObject<UItem>() : nullptr)
+	{ return TryAddItem_Internal(ItemDefaults, FMath::Max(Quantity, 0)); }
+
+	return FItemAddResult::AddedNone(-1, LOCTEXT("ErrorMessage", ""));
+}
+
+
+TArray<FItemAddResult> UInventoryComponent::TryAddItemsBatch(const TArray<FItemBatchEntry>& Entries)
+{
+	FInventoryBatchAddSummary BatchSummary;
+	TArray<int32> PlannedAmounts;
+
+	PlanBatchAdd(Entries, PlannedAmounts, BatchSummary.Results);
+
+	// the batch is reported by OnInventoryBatchAdded alone; set aside changes from before it, so the batch's own stay out of the end-of-frame update
+	FInventoryChangeSummary EarlierChanges = MoveTemp(PendingChanges);
+	const bool bEarlierChangesPending = bChangesPending;
+	PendingChanges.Reset();
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		if (PlannedAmounts[EntryIndex] <= 0)
+		{ continue; }
+
+		// weight was settled by the plan; stacks and slots are whole numbers, and AddedToInventory can only free room (i.e. by auto-equipping)
+		const int32 AmountAdded = AddToStacks(Entries[EntryIndex].ItemClass->GetDefaultObject<UItem>(), PlannedAmounts[EntryIndex]);
+
+		ensure(AmountAdded == PlannedAmounts[EntryIndex]);
+		BatchSummary.Results[EntryIndex].ActualAmountGiven = AmountAdded;
+	}
+
+	BatchSummary.Changes = MoveTemp(PendingChanges);
+	PendingChanges = MoveTemp(EarlierChanges);
+	bChangesPending = bEarlierChangesPending;
+
+	// the batch's changes enabled the tick, but nothing else is waiting on it
+	if (!bChangesPending)
+	{ SetComponentTickEnabled(false); }
+
+	OnInventoryBatchAdded.Broadcast(BatchSummary);
+
+	return MoveTemp(BatchSummary.Results);
+}
+
+
+void UInventoryComponent::PlanBatchAdd(const TArray<FItemBatchEntry>& Entries, TArray<int32>& OutAmounts, TArray<FItemAddResult>& OutResults) const
+{
+	OutAmounts.Reset(Entries.Num());
+	OutResults.Reset(Entries.Num());
+
+	int32 FreeSlots = FMath::Max(GetCapacity() - StackList.Items.Num(), 0);
+	float PlannedWeight = GetCurrentWeight();
+
+	// room left in each class's open stacks, including stacks the batch itself opens
+	TMap<const UClass*, int32> OpenRoom;
+
+	for (const FItemBatchEntry& Entry : Entries)
+	{
+		const UItem* ItemDefaults = Entry.ItemClass ? Entry.ItemClass->GetDefaultObject<UItem>() : nullptr;
+		const int32 Quantity = FMath::Max(Entry.Quantity, 0);
+
+		if (!ItemDefaults || !GetOwner())
+		{
+			OutAmounts.Add(0);
+			OutResults.Add(FItemAddResult::AddedNone(-1, LOCTEXT("ErrorMessage", "")));
+			continue;
+		}
+
+		const UClass* ItemClass = Entry.ItemClass;
+		const int32 MaxStackSize = FMath::Max(ItemDefaults->GetMaxStackSize(), 1);
+
+		int32* ClassOpenRoom = OpenRoom.Find(ItemClass);
+
+		if (!ClassOpenRoom)
+		{
+			int32 ExistingRoom = 0;
+
+			if (const FItemClassStacks* ClassStacks = ItemClassIndex.Find(ItemClass))
+			{
+				for (const int32 OpenStackId : ClassStacks->OpenStackIds)
+				{ ExistingRoom += MaxStackSize - StackList.Items[FindStackIndex(OpenStackId)].Quantity; }
+			}
+
+			ClassOpenRoom = &OpenRoom.Add(ItemClass, ExistingRoom);
+		}
+
+		// as TryAddItem_Internal: weight first, then open stacks, then new stacks while slots remain
+		const int32 Amount = GetWeightLimitedAmount(ItemDefaults, Quantity, PlannedWeight);
+		const bool bWeightLimited = Amount < Quantity;
+
+		const int32 FromOpenStacks = FMath::Min(Amount, *ClassOpenRoom);
+		const int32 NewStacks = FMath::Min(FMath::DivideAndRoundUp(Amount - FromOpenStacks, MaxStackSize), FreeSlots);
+		const int32 FromNewStacks = FMath::Min(Amount - FromOpenStacks, NewStacks * MaxStackSize);
+		const int32 PlannedAmount = FromOpenStacks + FromNewStacks;
+
+		*ClassOpenRoom += NewStacks * MaxStackSize - FromNewStacks - FromOpenStacks;
+		FreeSlots -= NewStacks;
+		PlannedWeight += PlannedAmount * ItemDefaults->GetWeight();
+
+		OutAmounts.Add(PlannedAmount);
+
+		// if weight didn't cut the add short, capacity did
+		const FText ErrorText = bWeightLimited && PlannedAmount == Amount
+			? LOCTEXT("BatchTooMuchWeightText", "Couldn't add item to inventory; carrying too much weight.")
+			: LOCTEXT("BatchCapacityFullText", "Couldn't add item to inventory; inventory is full.");
+
+		if (PlannedAmount >= Quantity)
+		{ OutResults.Add(FItemAddResult::AddedAll(Quantity)); }
+
+		else if (PlannedAmount > 0)
+		{ OutResults.Add(FItemAddResult::AddedSome(Quantity, PlannedAmount, ErrorText)); }
+
+		else
+		{ OutResults.Add(FItemAddResult::AddedNone(Quantity, ErrorText)); }
+	}
+}
+
+
+FItemAddResult UInventoryComponent::TransferItem(UInventoryComponent* Source, UInventoryComponent* Destination, class UItem* Item, const int32 Quantity)
+{
+	// only Source's own items map to one of its stacks
+	if (Source && Item && Item->OwningInventory == Source)
+	{ return TransferStack(Source, Destination, Item->OwningStackId, Quantity); }
+
+	return FItemAddResult::AddedNone(Quantity, LOCTEXT("TransferErrorText", "Couldn't transfer item."));
+}
+
+
+FItemAddResult UInventoryComponent::TransferStack(UInventoryComponent* Source, UInventoryComponent* Destination, const int32 StackId, const int32 Quantity)
+{
+	const int32 SourceIndex = (Source && Destination && Source != Destination) ? Source->FindStackIndex(StackId) : INDEX_NONE;
+
+	if (SourceIndex == INDEX_NONE || Quantity <= 0)
+	{ return FItemAddResult::AddedNone(Quantity, LOCTEXT("TransferErrorText", "Couldn't transfer item.")); }
+
+	FItemStack& SourceStack = Source->StackList.Items[SourceIndex];
+	const int32 TransferAmount = FMath::Min(Quantity, SourceStack.Quantity);
+
+	// the stack's own item (or the class defaults, if it has none yet) is the template. the item object only travels with a whole stack
+	const UItem* ItemTemplate = SourceStack.Instance ? SourceStack.Instance : SourceStack.GetItemDefaults();
+	UItem* MovingInstance = (TransferAmount == SourceStack.Quantity) ? SourceStack.Instance : nullptr;
+
+	if (!ItemTemplate)
+	{ return FItemAddResult::AddedNone(Quantity, LOCTEXT("TransferErrorText", "Couldn't transfer item.")); }
+
+	const FItemAddResult AddResult = Destination->TryAddItem_Internal(ItemTemplate, TransferAmount, MovingInstance);
+
+	if (AddResult.ActualAmountGiven > 0)
+	{
+		// adopted by Destination; the source stack mustn't push its quantity change to it
+		if (MovingInstance && MovingInstance->OwningInventory == Destination)
+		{ SourceStack.Instance = nullptr; }
+
+		Source->SetStackQuantity(SourceStack, SourceStack.Quantity - AddResult.ActualAmountGiven);
+
+		if (SourceStack.Quantity <= 0)
+		{ Source->RemoveStackAt(SourceIndex); }
+	}
+
+	return AddResult;
+}
+
+
+TArray<FItemAddResult> UInventoryComponent::TransferAllItems(UInventoryComponent* Source, UInventoryComponent* Destination)
+{
+	TArray<FItemAddResult> Results;
+
+	if (Source && Destination && Source != Destination)
+	{
+		Results.Reserve(Source->StackList.Items.Num());
+
+		// back to front, since a removal swaps an already-visited stack into the gap
+		for (int32 i = Source->StackList.Items.Num() - 1; i >= 0; --i)
+		{
+			const FItemStack& Stack = Source->StackList.Items[i];
+			Results.Add(TransferStack(Source, Destination, Stack.StackId, Stack.Quantity));
+		}
+	}
+
+	return Results;
 }
 
 
@@ -42,20 +276,24 @@ int32 UInventoryComponent::ConsumeItem(class UItem* Item, const int32 Quantity)
 {
 	if (GetOwner() && Item)
 	{
+		const int32 StackIndex = FindStackIndexForItem(Item);
+
+		if (StackIndex == INDEX_NONE)
+		{ return 0; }
+
+		FItemStack& Stack = StackList.Items[StackIndex];
+
 		// can't consume more than we have
-		const int32 RemoveQuantity = FMath::Min(Quantity, Item->GetQuantity());
+		const int32 RemoveQuantity = FMath::Min(Quantity, Stack.Quantity);
 
 		// shouldn't have a negative quantity after consumption
-		ensure(!(Item->GetQuantity() - RemoveQuantity < 0));
+		ensure(!(Stack.Quantity - RemoveQuantity < 0));
 
-		// now have zero of this item; remove it from inventory
-		Item->SetQuantity(Item->GetQuantity() - RemoveQuantity);
-
-		if (Item->GetQuantity() <= 0)
-		{ RemoveItem(Item); }
+		SetStackQuantity(Stack, Stack.Quantity - RemoveQuantity);
 
-		else
-		{ OnInventoryUpdated.Broadcast(); }
+		// now have zero of this item; remove it from inventory
+		if (Stack.Quantity <= 0)
+		{ RemoveStackAt(StackIndex); }
 
 		return RemoveQuantity;
 	}
@@ -69,12 +307,11 @@ bool UInventoryComponent::RemoveItem(class UItem* Item)
 {
 	if (GetOwner())
 	{
-		if (Item)
-		{
-			Items.RemoveSingle(Item);
-			OnRep_Items();
-			ReplicatedItemsKey++;
+		const int32 StackIndex = FindStackIndexForItem(Item);
 
+		if (StackIndex != INDEX_NONE)
+		{
+			RemoveStackAt(StackIndex);
 			return true;
 		}
 	}
@@ -86,8 +323,8 @@ bool UInventoryComponent::RemoveItem(class UItem* Item)
 // returns true if we have a given amount of an item
 bool UInventoryComponent::HasItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity /*= 1*/) const
 {
-	if (UItem* ItemToFind = FindItemByClass(ItemClass))
-	{ return ItemToFind->GetQuantity() >= Quantity; }
+	if (const FItemClassStacks* ClassStacks = ItemClassIndex.Find(ItemClass))
+	{ return ClassStacks->TotalQuantity >= Quantity; }
 
 	return false;
 }
@@ -97,13 +334,7 @@ bool UInventoryComponent::HasItem(TSubclassOf<class UItem> ItemClass, const int3
 UItem* UInventoryComponent::FindItem(class UItem* Item) const
 {
 	if (Item)
-	{
-		for (auto& InvItem : Items)
-		{
-			if (InvItem && InvItem->GetClass() == Item->GetClass())
-			{ return InvItem; }
-		}
-	}
+	{ return FindItemByClass(Item->GetClass()); }
 
 	return nullptr;
 }
@@ -112,11 +343,8 @@ UItem* UInventoryComponent::FindItem(class UItem* Item) const
 // returns the first item with the same class as ItemClass
 UItem* UInventoryComponent::FindItemByClass(TSubclassOf<class UItem> ItemClass) const
 {
-	for (auto& InvItem : Items)
-	{
-		if (InvItem && InvItem->GetClass() == ItemClass)
-		{ return InvItem; }
-	}
+	if (const FItemStack* Stack = FindStackByClass(ItemClass))
+	{ return MaterializeItem(*Stack); }
 
 	return nullptr;
 }
@@ -125,170 +353,765 @@ UItem* UInventoryComponent::FindItemByClass(TSubclassOf<class UItem> ItemClass)
 // get all inventory items that are a child of ItemClass. useful for getting all Weapons, all Consumables, etc
 TArray<UItem*> UInventoryComponent::FindItemsByClass(TSubclassOf<class UItem> ItemClass) const
 {
+	// category base classes already have a bucket
+	if (ItemClass == UWeaponItem::StaticClass())
+	{ return FindItemsByCategory(EItemCategory::EIC_Weapon); }
+
+	else if (ItemClass == UShieldItem::StaticClass())
+	{ return FindItemsByCategory(EItemCategory::EIC_Shield); }
+
+	else if (ItemClass == UGearItem::StaticClass())
+	{ return FindItemsByCategory(EItemCategory::EIC_Gear); }
+
+	else if (ItemClass == UAccessoryItem::StaticClass())
+	{ return FindItemsByCategory(EItemCategory::EIC_Accessory); }
+
+	else if (ItemClass == UItem::StaticClass())
+	{ return GetItems(); }
+
 	TArray<UItem*> ItemsOfClass;
 
-	for (auto& InvItem : Items)
+	for (auto& Stack : StackList.Items)
 	{
-		if (InvItem && InvItem->GetClass()->IsChildOf(ItemClass))
-		{ ItemsOfClass.Add(InvItem); }
+		if (Stack.ItemClass && Stack.ItemClass->IsChildOf(ItemClass))
+		{ ItemsOfClass.Add(MaterializeItem(Stack)); }
 	}
 
 	return ItemsOfClass;
 }
 
 
-float UInventoryComponent::GetCurrentWeight() const
+TArray<UItem*> UInventoryComponent::FindItemsByCategory(const EItemCategory Category) const
 {
-	float Weight = 0.0f;
+	return MaterializeItems(GetStackIdsInCategory(Category));
+}
+
+
+const TArray<int32>& UInventoryComponent::GetStackIdsInCategory(const EItemCategory Category) const
+{
+	check(Category < EItemCategory::EIC_MAX);
+	return CategoryBuckets[(uint8)Category];
+}
+
+
+EItemCategory UInventoryComponent::GetItemCategory(const UClass* ItemClass)
+{
+	if (!ItemClass || !ItemClass->IsChildOf(UEquippableItem::StaticClass()))
+	{ return EItemCategory::EIC_Consumable; }
+
+	else if (ItemClass->IsChildOf(UWeaponItem::StaticClass()))
+	{ return EItemCategory::EIC_Weapon; }
+
+	else if (ItemClass->IsChildOf(UShieldItem::StaticClass()))
+	{ return EItemCategory::EIC_Shield; }
+
+	else if (ItemClass->IsChildOf(UGearItem::StaticClass()))
+	{ return EItemCategory::EIC_Gear; }
+
+	else if (ItemClass->IsChildOf(UAccessoryItem::StaticClass()))
+	{ return EItemCategory::EIC_Accessory; }
 
-	for (auto& Item : Items)
+	return EItemCategory::EIC_Other;
+}
+
+
+TArray<UItem*> UInventoryComponent::GetSortedItems(const EInventorySortView View) const
+{
+	return MaterializeItems(GetSortedStackIds(View));
+}
+
+
+TArray<UItem*> UInventoryComponent::GetSortedItemsInCategory(const EInventorySortView View, const EItemCategory Category) const
+{
+	TArray<UItem*> SortedItems;
+	SortedItems.Reserve(GetStackIdsInCategory(Category).Num());
+
+	// filtering keeps the view's order
+	for (const int32 StackId : GetSortedStackIds(View))
 	{
-		if (Item)
-		{ Weight += Item->GetStackWeight(); }
+		const FItemStack* Stack = FindStack(StackId);
+
+		if (Stack && GetItemCategory(Stack->ItemClass) == Category)
+		{ SortedItems.Add(MaterializeItem(*Stack)); }
 	}
 
+	return SortedItems;
+}
+
+
+const TArray<int32>& UInventoryComponent::GetSortedStackIds(const EInventorySortView View) const
+{
+	check(View < EInventorySortView::EISV_MAX);
+	return SortedViews[(uint8)View];
+}
+
+
+bool UInventoryComponent::IsStackSortedBefore(const EInventorySortView View, const FItemStack& A, const FItemStack& B)
+{
+	const UItem* DefaultsA = A.GetItemDefaults();
+	const UItem* DefaultsB = B.GetItemDefaults();
+
+	if (DefaultsA && DefaultsB)
+	{
+		switch (View)
+		{
+		case EInventorySortView::EISV_Rarity:
+			if (DefaultsA->GetRarity() != DefaultsB->GetRarity())
+			{ return DefaultsA->GetRarity() > DefaultsB->GetRarity(); }
+			break;
+
+		case EInventorySortView::EISV_Weight:
+			if (A.GetStackWeight() != B.GetStackWeight())
+			{ return A.GetStackWeight() > B.GetStackWeight(); }
+			break;
+
+		case EInventorySortView::EISV_Category:
+			if (GetItemCategory(A.ItemClass) != GetItemCategory(B.ItemClass))
+			{ return GetItemCategory(A.ItemClass) < GetItemCategory(B.ItemClass); }
+			break;
+
+		default:
+			break;
+		}
+
+		const int32 NameOrder = DefaultsA->GetDisplayName().CompareTo(DefaultsB->GetDisplayName());
+
+		if (NameOrder != 0)
+		{ return NameOrder < 0; }
+	}
+
+	// stack ID last, so every stack has exactly one place in each view
+	return A.StackId < B.StackId;
+}
+
+
+void UInventoryComponent::InsertIntoSortedView(const EInventorySortView View, const int32 StackId)
+{
+	TArray<int32>& SortedView = SortedViews[(uint8)View];
+
+	const int32 InsertIndex = Algo::LowerBound(SortedView, StackId, [this, View](const int32 StackIdA, const int32 StackIdB)
+	{ return IsStackSortedBefore(View, *FindStack(StackIdA), *FindStack(StackIdB)); });
+
+	SortedView.Insert(StackId, InsertIndex);
+}
+
+
+UItem* UInventoryComponent::GetItemForStack(const int32 StackId) const
+{
+	if (const FItemStack* Stack = FindStack(StackId))
+	{ return MaterializeItem(*Stack); }
+
+	return nullptr;
+}
+
+
+const FItemStack* UInventoryComponent::FindStack(const int32 StackId) const
+{
+	const int32 StackIndex = FindStackIndex(StackId);
+	return StackIndex != INDEX_NONE ? &StackList.Items[StackIndex] : nullptr;
+}
+
+
+const FItemStack* UInventoryComponent::FindStackByClass(const UClass* ItemClass) const
+{
+	const int32 StackIndex = FindStackIndexByClass(ItemClass);
+	return StackIndex != INDEX_NONE ? &StackList.Items[StackIndex] : nullptr;
+}
+
+
+TArray<UItem*> UInventoryComponent::GetItems() const
+{
+	TArray<UItem*> AllItems;
+	AllItems.Reserve(StackList.Items.Num());
+
+	for (auto& Stack : StackList.Items)
+	{ AllItems.Add(MaterializeItem(Stack)); }
+
+	return AllItems;
+}
+
+
+void UInventoryComponent::PrefetchPresentationAssets()
+{
+	// class defaults carry the same soft references, so no item objects need creating
+	TArray<const UItem*> ItemDefaults;
+	ItemDefaults.Reserve(StackList.Items.Num());
+
+	for (auto& Stack : StackList.Items)
+	{ ItemDefaults.AddUnique(Stack.GetItemDefaults()); }
+
+	// requested before the previous handle is released, so anything already loaded stays loaded
+	TSharedPtr<FStreamableHandle> PreviousHandle = PresentationAssetsHandle;
+	PresentationAssetsHandle = UItem::LoadPresentationAssets(ItemDefaults);
+
+	if (PreviousHandle.IsValid())
+	{ PreviousHandle->ReleaseHandle(); }
+}
+
+
+void UInventoryComponent::ReleasePresentationAssets()
+{
+	if (PresentationAssetsHandle.IsValid())
+	{
+		PresentationAssetsHandle->ReleaseHandle();
+		PresentationAssetsHandle.Reset();
+	}
+}
+
+
+int32 UInventoryComponent::FindStackIndex(const int32 StackId) const
+{
+	const int32* StackIndex = StackIndices.Find(StackId);
+	return StackIndex ? *StackIndex : INDEX_NONE;
+}
+
+
+int32 UInventoryComponent::FindStackIndexByClass(const UClass* ItemClass) const
+{
+	if (const FItemClassStacks* ClassStacks = ItemClassIndex.Find(ItemClass))
+	{ return FindStackIndex(ClassStacks->StackIds[0]); }
+
+	return INDEX_NONE;
+}
+
+
+int32 UInventoryComponent::FindStackIndexForItem(const class UItem* Item) const
+{
+	// only our own materialized items map to a stack
+	if (Item && Item->OwningInventory == this)
+	{ return FindStackIndex(Item->OwningStackId); }
+
+	return INDEX_NONE;
+}
+
+
+UItem* UInventoryComponent::MaterializeItem(const FItemStack& Stack) const
+{
+	if (!Stack.Instance && Stack.ItemClass && GetOwner())
+	{
+		// created on first request, then kept with the stack (hence the const_cast) so per-item state like equip status persists
+		UItem* NewItem = NewObject<UItem>(GetOwner(), Stack.ItemClass);
+		NewItem->Quantity = Stack.Quantity;
+		NewItem->bShouldNotifyOnInventoryAdd = Stack.bShouldNotifyOnInventoryAdd;
+		NewItem->bShouldAutoEquip = Stack.bShouldAutoEquip;
+		NewItem->OwningInventory = const_cast<UInventoryComponent*>(this);
+		NewItem->OwningStackId = Stack.StackId;
+
+		const_cast<FItemStack&>(Stack).Instance = NewItem;
+	}
+
+	return Stack.Instance;
+}
+
+
+TArray<UItem*> UInventoryComponent::MaterializeItems(const TArray<int32>& StackIds) const
+{
+	TArray<UItem*> StackItems;
+	StackItems.Reserve(StackIds.Num());
+
+	for (const int32 StackId : StackIds)
+	{
+		if (UItem* StackItem = GetItemForStack(StackId))
+		{ StackItems.Add(StackItem); }
+	}
+
+	return StackItems;
+}
+
+
+float UInventoryComponent::CalculateCurrentWeight() const
+{
+	float Weight = 0.0f;
+
+	for (auto& Stack : StackList.Items)
+	{ Weight += Stack.GetStackWeight(); }
+
 	return Weight;
 }
 
 
+void UInventoryComponent::OnItemQuantityChanged(const class UItem* Item)
+{
+	const int32 StackIndex = FindStackIndexForItem(Item);
+
+	if (StackIndex != INDEX_NONE)
+	{
+		// item already holds the new quantity; bring the stack in line
+		FItemStack& Stack = StackList.Items[StackIndex];
+		const int32 OldQuantity = Stack.Quantity;
+		Stack.Quantity = Item->GetQuantity();
+
+		if (Stack.Quantity != OldQuantity)
+		{ OnStackQuantityChanged(Stack, OldQuantity); }
+	}
+}
+
+
+#if DO_GUARD_SLOW
+void UInventoryComponent::ValidateCurrentWeight() const
+{
+	const float CalculatedWeight = CalculateCurrentWeight();
+
+	// allow for float drift accumulated over many adds/removes
+	ensureMsgf(FMath::IsNearlyEqual(CurrentWeight, CalculatedWeight, 0.01f), TEXT("%s: running weight %f doesn't match calculated weight %f"), *GetPathName(), CurrentWeight, CalculatedWeight);
+}
+#endif
+
+
 void UInventoryComponent::SetWeightCapacity(const float NewWeightCapacity)
 {
 	WeightCapacity = NewWeightCapacity;
-	OnInventoryUpdated.Broadcast();
+	PendingChanges.bCapacityChanged = true;
+	MarkChangesPending();
 }
 
 
 void UInventoryComponent::SetCapacity(const int32 NewCapacity)
 {
 	Capacity = NewCapacity;
-	OnInventoryUpdated.Broadcast();
+	PendingChanges.bCapacityChanged = true;
+	MarkChangesPending();
 }
 
 
-void UInventoryComponent::OnRep_Items()
+void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	OnInventoryUpdated.Broadcast();
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UInventoryComponent, StackList);
 }
 
 
-UItem* UInventoryComponent::AddItem(class UItem* Item)
+void FItemStack::PreReplicatedRemove(const FItemStackList& InArraySerializer)
 {
-	if (GetOwner())
+	if (InArraySerializer.OwningInventory)
+	{ InArraySerializer.OwningInventory->OnStackReplicatedRemove(*this); }
+}
+
+
+void FItemStack::PostReplicatedAdd(const FItemStackList& InArraySerializer)
+{
+	if (InArraySerializer.OwningInventory)
+	{ InArraySerializer.OwningInventory->OnStackReplicatedAdd(*this); }
+}
+
+
+void FItemStack::PostReplicatedChange(const FItemStackList& InArraySerializer)
+{
+	if (InArraySerializer.OwningInventory)
+	{ InArraySerializer.OwningInventory->OnStackReplicatedChange(*this); }
+}
+
+
+void FItemStackList::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (OwningInventory)
+	{ OwningInventory->OnStacksReplicated(); }
+}
+
+
+void UInventoryComponent::OnStackReplicatedRemove(const FItemStack& Stack)
+{
+	// materialized items aren't replicated; the client's own copy is no longer ours
+	if (Stack.Instance && Stack.Instance->OwningInventory == this)
 	{
-		// reconstruct/duplicate item, this instance owned by inventory component
-		UItem* NewItem = NewObject<UItem>(GetOwner(), Item->GetClass());
-		NewItem->SetQuantity(Item->GetQuantity());
-		NewItem->OwningInventory = this;
-		NewItem->bShouldNotifyOnInventoryAdd = Item->bShouldNotifyOnInventoryAdd;
-		NewItem->bShouldAutoEquip = Item->bShouldAutoEquip;
-		NewItem->AddedToInventory(this, Item->GetQuantity());
-		Items.Add(NewItem);
-		OnRep_Items();
-
-		return NewItem;
+		Stack.Instance->OwningInventory = nullptr;
+		Stack.Instance->OwningStackId = INDEX_NONE;
 	}
 
-	return nullptr;
+	MarkStackRemoved(Stack.StackId);
 }
 
-// wrapper function for AddItem - checks capacity/stacks prior to add, and adds partial if needed
-FItemAddResult UInventoryComponent::TryAddItem_Internal(class UItem* Item)
+
+void UInventoryComponent::OnStackReplicatedAdd(const FItemStack& Stack)
 {
-	if (GetOwner())
+	MarkStackAdded(Stack.StackId);
+}
+
+
+void UInventoryComponent::OnStackReplicatedChange(const FItemStack& Stack)
+{
+	// keep the client's materialized item (and anything bound to it) in step
+	if (Stack.Instance)
 	{
-		const int32 AddAmount = Item->GetQuantity();
+		Stack.Instance->Quantity = Stack.Quantity;
+		Stack.Instance->bShouldNotifyOnInventoryAdd = Stack.bShouldNotifyOnInventoryAdd;
+		Stack.Instance->bShouldAutoEquip = Stack.bShouldAutoEquip;
+		Stack.Instance->OnItemModified.Broadcast();
+	}
+
+	MarkStackModified(Stack.StackId);
+}
+
+
+void UInventoryComponent::OnStacksReplicated()
+{
+	// removals swap stacks around on the client too; indices and weight are stale
+	RebuildStackIndices();
+	CurrentWeight = CalculateCurrentWeight();
+}
+
+
+void UInventoryComponent::MarkChangesPending()
+{
+	if (!bChangesPending)
+	{
+		bChangesPending = true;
+
+		// changes made during construction/setup are dropped on BeginPlay
+		if (HasBegunPlay())
+		{ SetComponentTickEnabled(true); }
+	}
+}
+
+
+void UInventoryComponent::MarkStackAdded(const int32 StackId)
+{
+	PendingChanges.AddedStackIds.Add(StackId);
+
+	MarkChangesPending();
+}
+
+
+void UInventoryComponent::MarkStackRemoved(const int32 StackId)
+{
+	// added and removed within the same frame; listeners never saw it
+	if (PendingChanges.AddedStackIds.RemoveSingle(StackId) == 0)
+	{
+		PendingChanges.ModifiedStackIds.RemoveSingle(StackId);
+		PendingChanges.RemovedStackIds.Add(StackId);
+	}
+
+	MarkChangesPending();
+}
+
+
+void UInventoryComponent::MarkStackModified(const int32 StackId)
+{
+	// newly added stacks are reported with their final quantity anyway
+	if (!PendingChanges.AddedStackIds.Contains(StackId))
+	{ PendingChanges.ModifiedStackIds.AddUnique(StackId); }
+
+	MarkChangesPending();
+}
+
+
+void UInventoryComponent::RebuildStackIndices()
+{
+	StackIndices.Reset();
+	ItemClassIndex.Reset();
+
+	for (auto& Bucket : CategoryBuckets)
+	{ Bucket.Reset(); }
+
+	for (auto& SortedView : SortedViews)
+	{ SortedView.Reset(); }
+
+	for (int32 i = 0; i < StackList.Items.Num(); ++i)
+	{
+		const FItemStack& Stack = StackList.Items[i];
+
+		StackIndices.Add(Stack.StackId, i);
+
+		FItemClassStacks& ClassStacks = ItemClassIndex.FindOrAdd(Stack.ItemClass.Get());
+		ClassStacks.StackIds.Add(Stack.StackId);
+		ClassStacks.TotalQuantity += Stack.Quantity;
+		UpdateOpenStack(ClassStacks, Stack);
+
+		CategoryBuckets[(uint8)GetItemCategory(Stack.ItemClass)].Add(Stack.StackId);
+		NextStackId = FMath::Max(NextStackId, Stack.StackId + 1);
+
+		for (auto& SortedView : SortedViews)
+		{ SortedView.Add(Stack.StackId); }
+	}
+
+	// a replication update can change any number of stacks at once, so re-sort the views in one go
+	for (uint8 View = 0; View < (uint8)EInventorySortView::EISV_MAX; ++View)
+	{
+		SortedViews[View].Sort([this, View](const int32 StackIdA, const int32 StackIdB)
+		{ return IsStackSortedBefore((EInventorySortView)View, *FindStack(StackIdA), *FindStack(StackIdB)); });
+	}
+}
 
-		// check capacity for room; add None if full
-		if (Items.Num() + 1 > GetCapacity())
-		{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryCapacityFullText", "Couldn't add item to inventory; inventory is full.")); }
 
-		// items with zero weight don't require a weight check
-		if (!FMath::IsNearlyZero(Item->Weight))
+void UInventoryComponent::SetStackQuantity(FItemStack& Stack, const int32 NewQuantity)
+{
+	if (NewQuantity != Stack.Quantity)
+	{
+		const int32 OldQuantity = Stack.Quantity;
+		Stack.Quantity = NewQuantity;
+
+		// keep the materialized item (and anything bound to it) in step
+		if (Stack.Instance)
 		{
-			// check weight capacity; add None if reached
-			if (GetCurrentWeight() + Item->Weight > GetWeightCapacity())
-			{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryTooMuchWeightText", "Couldn't add item to inventory; carrying too much weight.")); }
+			Stack.Instance->Quantity = NewQuantity;
+			Stack.Instance->OnItemModified.Broadcast();
 		}
 
-		// if item is stackable, check if we already have any and if so add to corresponding stack
-		if (Item->bStackable)
-		{
-			// should never go over max stack size
-			ensure(Item->GetQuantity() <= Item->MaxStackSize);
+		OnStackQuantityChanged(Stack, OldQuantity);
+	}
+}
 
-			// if already have some of item and stackable, modify (increment) existing inventory quantity instead of adding entirely new
-			if (UItem* ExistingItem = FindItem(Item))
-			{
-				// if room in stack
-				if (ExistingItem->GetQuantity() < ExistingItem->MaxStackSize)
-				{
-					// determine how much of the item to add
-					const int32 CapacityMaxAddAmount = ExistingItem->MaxStackSize - ExistingItem->GetQuantity();
-					int32 ActualAddAmount = FMath::Min(AddAmount, CapacityMaxAddAmount);
-
-					FText ErrorText = LOCTEXT("InventoryErrorText", "Couldn't add all of the item to your inventory.");
-
-					// adjust based on how much weight we can carry
-					if (!FMath::IsNearlyZero(Item->Weight))
-					{
-						// find the max amount of the item we could take on (due to weight)
-						const int32 WeightMaxAddAmount = FMath::FloorToInt((WeightCapacity - GetCurrentWeight()) / Item->Weight);
-						ActualAddAmount = FMath::Min(ActualAddAmount, WeightMaxAddAmount);
-
-						if (ActualAddAmount < AddAmount)
-						{ ErrorText = FText::Format(LOCTEXT("InventoryTooMuchWeightText", "Couldn't add entire stack of {ItemName} to inventory."), Item->ItemDisplayName); }
-					}
-
-					else if (ActualAddAmount < AddAmount)
-					{
-						// if the item weighs 0 but we can't take it, then the issue was capacity
-						ErrorText = FText::Format(LOCTEXT("InventoryCapacityFullText", "Couldn't add entire stack of {ItemName} to inventory. Inventory was full."), Item->ItemDisplayName);
-					}
-
-					// we couldn't add *any* of the item to inventory
-					if (ActualAddAmount <= 0)
-					{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryErrorText", "Couldn't add item to inventory.")); }
-
-					// success, checks passed: increment item quantity
-					ExistingItem->SetQuantity(ExistingItem->GetQuantity() + ActualAddAmount);
-					ExistingItem->bShouldNotifyOnInventoryAdd = Item->bShouldNotifyOnInventoryAdd;
-					ExistingItem->bShouldAutoEquip = Item->bShouldAutoEquip;
-					// call AddedToInventory for client notification / sound effect
-					ExistingItem->AddedToInventory(this, ActualAddAmount);
-
-					// if we somehow get more of the item than the max stack size, something is wrong with the math
-					ensure(ExistingItem->GetQuantity() <= ExistingItem->MaxStackSize);
-
-					if (ActualAddAmount < AddAmount)
-					{ return FItemAddResult::AddedSome(AddAmount, ActualAddAmount, ErrorText); }
-
-					else
-					{ return FItemAddResult::AddedAll(AddAmount); }
-				}
-
-				else
-				{ return FItemAddResult::AddedNone(AddAmount, FText::Format(LOCTEXT("InventoryFullStackText", "Couldn't add {ItemName}. You already have a full stack of this item."), Item->ItemDisplayName)); }
-			}
 
-			else
-			{
-				// since we do not have any of this item, add the full stack
-				AddItem(Item);
-				return FItemAddResult::AddedAll(AddAmount);
-			}
+void UInventoryComponent::OnStackQuantityChanged(FItemStack& Stack, const int32 OldQuantity)
+{
+	if (const UItem* ItemDefaults = Stack.GetItemDefaults())
+	{ CurrentWeight += (Stack.Quantity - OldQuantity) * ItemDefaults->GetWeight(); }
+
+	if (FItemClassStacks* ClassStacks = ItemClassIndex.Find(Stack.ItemClass.Get()))
+	{
+		ClassStacks->TotalQuantity += Stack.Quantity - OldQuantity;
+		UpdateOpenStack(*ClassStacks, Stack);
+	}
+
+	// stack weight is the only sort key quantity affects
+	if (SortedViews[(uint8)EInventorySortView::EISV_Weight].RemoveSingle(Stack.StackId) > 0)
+	{ InsertIntoSortedView(EInventorySortView::EISV_Weight, Stack.StackId); }
+
+	StackList.MarkItemDirty(Stack);
+	MarkStackModified(Stack.StackId);
+
+#if DO_GUARD_SLOW
+	ValidateCurrentWeight();
+#endif
+}
+
+
+void UInventoryComponent::UpdateOpenStack(FItemClassStacks& ClassStacks, const FItemStack& Stack)
+{
+	// only a stack or two per class is ever open in practice, so these scans stay short
+	if (Stack.Quantity < Stack.GetMaxStackSize())
+	{ ClassStacks.OpenStackIds.AddUnique(Stack.StackId); }
+
+	else
+	{ ClassStacks.OpenStackIds.RemoveSingle(Stack.StackId); }
+}
+
+
+int32 UInventoryComponent::AddStack(const class UItem* Item, const int32 Quantity, class UItem* InstanceToAdopt /*= nullptr*/)
+{
+	if (GetOwner())
+	{
+		// plain data; an item object is only created for the stack when something asks for one
+		FItemStack NewStack;
+		NewStack.ItemClass = Item->GetClass();
+		NewStack.Quantity = Quantity;
+		NewStack.bShouldNotifyOnInventoryAdd = Item->bShouldNotifyOnInventoryAdd;
+		NewStack.bShouldAutoEquip = Item->bShouldAutoEquip;
+		NewStack.StackId = NextStackId++;
+
+		if (InstanceToAdopt)
+		{
+			// transferred from another inventory; re-home it rather than creating a new one
+			if (InstanceToAdopt->GetOuter() != GetOwner())
+			{ InstanceToAdopt->Rename(nullptr, GetOwner(), REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty); }
+
+			InstanceToAdopt->Quantity = Quantity;
+			InstanceToAdopt->OwningInventory = this;
+			InstanceToAdopt->OwningStackId = NewStack.StackId;
+			NewStack.Instance = InstanceToAdopt;
 		}
 
-		else // item isn't stackable
+		const int32 StackIndex = StackList.Items.Add(NewStack);
+		StackList.MarkItemDirty(StackList.Items[StackIndex]);
+		StackIndices.Add(NewStack.StackId, StackIndex);
+
+		FItemClassStacks& ClassStacks = ItemClassIndex.FindOrAdd(NewStack.ItemClass.Get());
+		ClassStacks.StackIds.Add(NewStack.StackId);
+		ClassStacks.TotalQuantity += NewStack.Quantity;
+		UpdateOpenStack(ClassStacks, NewStack);
+
+		CategoryBuckets[(uint8)GetItemCategory(NewStack.ItemClass)].Add(NewStack.StackId);
+		CurrentWeight += NewStack.GetStackWeight();
+
+		for (uint8 View = 0; View < (uint8)EInventorySortView::EISV_MAX; ++View)
+		{ InsertIntoSortedView((EInventorySortView)View, NewStack.StackId); }
+
+#if DO_GUARD_SLOW
+		ValidateCurrentWeight();
+#endif
+
+		MarkStackAdded(NewStack.StackId);
+		NotifyStackAdded(StackIndex, Quantity);
+
+		return StackIndex;
+	}
+
+	return INDEX_NONE;
+}
+
+
+void UInventoryComponent::RemoveStackAt(const int32 StackIndex)
+{
+	const FItemStack& Stack = StackList.Items[StackIndex];
+	const int32 StackId = Stack.StackId;
+	const UClass* ItemClass = Stack.ItemClass.Get();
+
+	CurrentWeight -= Stack.GetStackWeight();
+
+	// item is no longer ours; its quantity changes shouldn't touch our stacks
+	if (Stack.Instance && Stack.Instance->OwningInventory == this)
+	{
+		Stack.Instance->OwningInventory = nullptr;
+		Stack.Instance->OwningStackId = INDEX_NONE;
+	}
+
+	// keep the indices in step
+	if (FItemClassStacks* ClassStacks = ItemClassIndex.Find(ItemClass))
+	{
+		ClassStacks->StackIds.RemoveSingle(StackId);
+		ClassStacks->OpenStackIds.RemoveSingle(StackId);
+		ClassStacks->TotalQuantity -= Stack.Quantity;
+
+		if (ClassStacks->StackIds.Num() == 0)
+		{ ItemClassIndex.Remove(ItemClass); }
+	}
+
+	CategoryBuckets[(uint8)GetItemCategory(ItemClass)].RemoveSingle(StackId);
+
+	for (auto& SortedView : SortedViews)
+	{ SortedView.RemoveSingle(StackId); }
+
+	StackIndices.Remove(StackId);
+
+	// last stack moves into the gap
+	StackList.Items.RemoveAtSwap(StackIndex);
+
+	if (StackList.Items.IsValidIndex(StackIndex))
+	{ StackIndices.Add(StackList.Items[StackIndex].StackId, StackIndex); }
+
+#if DO_GUARD_SLOW
+	ValidateCurrentWeight();
+#endif
+
+	// removal can't be marked per item
+	StackList.MarkArrayDirty();
+	MarkStackRemoved(StackId);
+}
+
+
+void UInventoryComponent::NotifyStackAdded(const int32 StackIndex, const int32 QuantityAdded)
+{
+	// AddedToInventory only acts on a character's inventory (hud notification, sound, auto-equip), so only there does an add need the item object
+	if (Cast<AMain>(GetOwner()))
+	{
+		if (UItem* StackItem = MaterializeItem(StackList.Items[StackIndex]))
+		{ StackItem->AddedToInventory(this, QuantityAdded); }
+	}
+}
+
+
+int32 UInventoryComponent::GetWeightLimitedAmount(const class UItem* Item, const int32 Amount, const float CarriedWeight) const
+{
+	// items with zero weight don't require a weight check
+	if (FMath::IsNearlyZero(Item->GetWeight()))
+	{ return Amount; }
+
+	// the max amount of the item we could take on
+	const int32 WeightMaxAddAmount = FMath::Max(FMath::FloorToInt((GetWeightCapacity() - CarriedWeight) / Item->GetWeight()), 0);
+	return FMath::Min(Amount, WeightMaxAddAmount);
+}
+
+
+// wrapper function for AddToStacks - checks capacity/weight prior to add, and adds partial if needed
+FItemAddResult UInventoryComponent::TryAddItem_Internal(const class UItem* Item, const int32 AddAmount, class UItem* InstanceToAdopt /*= nullptr*/)
+{
+	if (GetOwner())
+	{
+		const UClass* ItemClass = Item->GetClass();
+		const FItemClassStacks* ExistingClassStacks = ItemClassIndex.Find(ItemClass);
+
+		// check capacity for room (either a stack with room or a free slot); add None if full
+		if ((!ExistingClassStacks || ExistingClassStacks->OpenStackIds.Num() == 0) && StackList.Items.Num() + 1 > GetCapacity())
+		{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryCapacityFullText", "Couldn't add item to inventory; inventory is full.")); }
+
+		const int32 WeightLimitedAmount = GetWeightLimitedAmount(Item, AddAmount, GetCurrentWeight());
+
+		// check weight capacity; add None if reached
+		if (WeightLimitedAmount <= 0 && AddAmount > 0)
+		{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryTooMuchWeightText", "Couldn't add item to inventory; carrying too much weight.")); }
+
+		const bool bWeightLimited = WeightLimitedAmount < AddAmount;
+
+		// a transferred item object can only become the new stack's item if it arrives whole
+		const int32 ActualAddAmount = AddToStacks(Item, WeightLimitedAmount, bWeightLimited ? nullptr : InstanceToAdopt);
+
+		// we couldn't add *any* of the item to inventory
+		if (ActualAddAmount <= 0)
+		{ return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryErrorText", "Couldn't add item to inventory.")); }
+
+		else if (ActualAddAmount < AddAmount)
 		{
-			// non-stackable items should always have a quantity of 1
-			ensure(Item->GetQuantity() == 1);
+			// if weight didn't cut the add short, capacity did
+			const FText ErrorText = bWeightLimited && ActualAddAmount == WeightLimitedAmount
+				? FText::Format(LOCTEXT("InventoryTooMuchWeightText", "Couldn't add entire stack of {ItemName} to inventory."), Item->GetDisplayName())
+				: FText::Format(LOCTEXT("InventoryCapacityFullText", "Couldn't add entire stack of {ItemName} to inventory. Inventory was full."), Item->GetDisplayName());
 
-			AddItem(Item);
-			return FItemAddResult::AddedAll(AddAmount);
+			return FItemAddResult::AddedSome(AddAmount, ActualAddAmount, ErrorText);
 		}
+
+		return FItemAddResult::AddedAll(AddAmount);
 	}
 
 	return FItemAddResult::AddedNone(-1, LOCTEXT("ErrorMessage", ""));
 }
 
+
+int32 UInventoryComponent::AddToStacks(const class UItem* Item, const int32 Amount, class UItem* InstanceToAdopt /*= nullptr*/)
+{
+	const UClass* ItemClass = Item->GetClass();
+	const int32 MaxStackSize = Item->GetMaxStackSize();
+	int32 RemainingAmount = Amount;
+
+	// if already have some of item, top up (increment) existing stacks with room before adding entirely new ones
+	while (RemainingAmount > 0)
+	{
+		// looked up each time round; AddedToInventory (i.e., auto-equip) may have changed the index
+		const FItemClassStacks* ClassStacks = ItemClassIndex.Find(ItemClass);
+
+		if (!ClassStacks || ClassStacks->OpenStackIds.Num() == 0)
+		{ break; }
+
+		const int32 OpenStackIndex = FindStackIndex(ClassStacks->OpenStackIds.Last());
+		FItemStack& OpenStack = StackList.Items[OpenStackIndex];
+		const int32 StackAddAmount = FMath::Min(RemainingAmount, MaxStackSize - OpenStack.Quantity);
+
+		// an open stack always has room; bail rather than spin if the index says otherwise
+		if (!ensure(StackAddAmount > 0))
+		{ break; }
+
+		OpenStack.bShouldNotifyOnInventoryAdd = Item->bShouldNotifyOnInventoryAdd;
+		OpenStack.bShouldAutoEquip = Item->bShouldAutoEquip;
+
+		if (OpenStack.Instance)
+		{
+			OpenStack.Instance->bShouldNotifyOnInventoryAdd = Item->bShouldNotifyOnInventoryAdd;
+			OpenStack.Instance->bShouldAutoEquip = Item->bShouldAutoEquip;
+		}
+
+		// closes the stack (drops it from OpenStackIds) once it's full
+		SetStackQuantity(OpenStack, OpenStack.Quantity + StackAddAmount);
+
+		// if we somehow get more of the item than the max stack size, something is wrong with the math
+		ensure(OpenStack.Quantity <= MaxStackSize);
+
+		// call AddedToInventory for client notification / sound effect
+		NotifyStackAdded(OpenStackIndex, StackAddAmount);
+
+		RemainingAmount -= StackAddAmount;
+	}
+
+	// spill whatever's left into new stacks, as capacity allows
+	while (RemainingAmount > 0 && StackList.Items.Num() < GetCapacity())
+	{
+		const int32 StackAddAmount = FMath::Min(RemainingAmount, MaxStackSize);
+
+		AddStack(Item, StackAddAmount, (StackAddAmount == Amount) ? InstanceToAdopt : nullptr);
+
+		RemainingAmount -= StackAddAmount;
+	}
+
+	return Amount - RemainingAmount;
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
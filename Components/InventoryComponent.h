@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 
 #include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
 #include "../Items/Item.h"
 #include "InventoryComponent.generated.h"
 
@@ -19,6 +20,32 @@ enum class EItemAddResult : uint8
 	IAR_AllItemsAdded UMETA(DisplayName = "All items added")
 };
 
+// inventory bucket an item is sorted into when added; consumables are any non-equippable item
+UENUM(BlueprintType)
+enum class EItemCategory : uint8
+{
+	EIC_Weapon UMETA(DisplayName = "Weapon"),
+	EIC_Shield UMETA(DisplayName = "Shield"),
+	EIC_Gear UMETA(DisplayName = "Gear"),
+	EIC_Accessory UMETA(DisplayName = "Accessory"),
+	EIC_Consumable UMETA(DisplayName = "Consumable"),
+	EIC_Other UMETA(DisplayName = "Other"),
+
+	EIC_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+// orders the inventory keeps its stacks in, for menus; ties are broken by display name
+UENUM(BlueprintType)
+enum class EInventorySortView : uint8
+{
+	EISV_Rarity UMETA(DisplayName = "Rarity"),		// rarest first
+	EISV_Weight UMETA(DisplayName = "Weight"),		// heaviest stack first
+	EISV_Name UMETA(DisplayName = "Name"),			// alphabetical
+	EISV_Category UMETA(DisplayName = "Category"),	// in EItemCategory order
+
+	EISV_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
 // represents the result of adding an item to the inventory 
 USTRUCT(BlueprintType)
 struct FItemAddResult
@@ -80,22 +107,214 @@ public:
 	}
 };
 
+// one entry of a batched add: an item class and the quantity of it to add
+USTRUCT(BlueprintType)
+struct FItemBatchEntry
+{
+	GENERATED_BODY()
+
+public:
+
+	FItemBatchEntry() : Quantity(1) {};
+	FItemBatchEntry(TSubclassOf<class UItem> InItemClass, int32 InQuantity) : ItemClass(InItemClass), Quantity(InQuantity) {};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Batch Entry")
+	TSubclassOf<class UItem> ItemClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Batch Entry")
+	int32 Quantity;
+};
+
+/* a stack of one item class held by an inventory. inventories store these by value; a UItem is only created for a stack
+when something actually needs one (Blueprint UI, Use(), equipping), and is then kept with the stack */
+USTRUCT(BlueprintType)
+struct FItemStack : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+
+	FItemStack() : Quantity(0), bShouldNotifyOnInventoryAdd(true), bShouldAutoEquip(false), StackId(INDEX_NONE), Instance(nullptr) {};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Stack")
+	TSubclassOf<class UItem> ItemClass;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Stack")
+	int32 Quantity;
+
+	UPROPERTY()
+	bool bShouldNotifyOnInventoryAdd;
+
+	UPROPERTY()
+	bool bShouldAutoEquip;
+
+	// identifies the stack within its inventory; unlike its array index, stable for the stack's lifetime
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Stack")
+	int32 StackId;
+
+	// the stack's item object, if one has been materialized (see UInventoryComponent::GetItemForStack)
+	UPROPERTY(Transient, NotReplicated)
+	class UItem* Instance;
+
+	// the item class's defaults (weight, max stack size, display data, etc)
+	FORCEINLINE const UItem* GetItemDefaults() const { return ItemClass ? ItemClass->GetDefaultObject<UItem>() : nullptr; }
+
+	// non-stackable items always stack to one
+	FORCEINLINE int32 GetMaxStackSize() const
+	{
+		const UItem* ItemDefaults = GetItemDefaults();
+		return ItemDefaults ? ItemDefaults->GetMaxStackSize() : 1;
+	}
+
+	FORCEINLINE float GetStackWeight() const
+	{
+		const UItem* ItemDefaults = GetItemDefaults();
+		return ItemDefaults ? Quantity * ItemDefaults->GetWeight() : 0.0f;
+	}
+
+	// client-side replication callbacks; forwarded to the owning inventory
+	void PreReplicatedRemove(const struct FItemStackList& InArraySerializer);
+	void PostReplicatedAdd(const struct FItemStackList& InArraySerializer);
+	void PostReplicatedChange(const struct FItemStackList& InArraySerializer);
+};
+
+// an inventory's stacks, delta-replicated: only added, changed and removed stacks are sent, rather than the whole array
+USTRUCT()
+struct FItemStackList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+
+	FItemStackList() : OwningInventory(nullptr) {};
+
+	UPROPERTY(VisibleAnywhere, Category = "Item Stack List")
+	TArray<FItemStack> Items;
+
+	// set by the owning inventory; not a UPROPERTY, so it's never copied from an archetype
+	class UInventoryComponent* OwningInventory;
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{ return FFastArraySerializer::FastArrayDeltaSerialize<FItemStack, FItemStackList>(Items, DeltaParms, *this); }
+};
+
+template<>
+struct TStructOpsTypeTraits<FItemStackList> : public TStructOpsTypeTraitsBase2<FItemStackList>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+// everything that changed in the inventory since the last update broadcast, so widgets can patch themselves instead of fully rebuilding
+USTRUCT(BlueprintType)
+struct FInventoryChangeSummary
+{
+	GENERATED_BODY()
+
+public:
+
+	FInventoryChangeSummary() : bCapacityChanged(false) {};
+
+	// stacks new to the inventory (a stack both added and removed in the same frame isn't reported)
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Change Summary")
+	TArray<int32> AddedStackIds;
+
+	// stacks no longer in the inventory
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Change Summary")
+	TArray<int32> RemovedStackIds;
+
+	// stacks still in the inventory whose quantity changed
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Change Summary")
+	TArray<int32> ModifiedStackIds;
+
+	// capacity or weight capacity changed
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Change Summary")
+	bool bCapacityChanged;
+
+	void Reset()
+	{
+		AddedStackIds.Reset();
+		RemovedStackIds.Reset();
+		ModifiedStackIds.Reset();
+		bCapacityChanged = false;
+	}
+};
+
+// called once at the end of any frame in which the inventory changed, with a summary of what changed
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryChanged, const FInventoryChangeSummary&, ChangeSummary);
+
+// the outcome of one TryAddItemsBatch call, broadcast as soon as the batch has been applied
+USTRUCT(BlueprintType)
+struct FInventoryBatchAddSummary
+{
+	GENERATED_BODY()
+
+public:
+
+	// the add result for each entry, in entry order
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Batch Add Summary")
+	TArray<FItemAddResult> Results;
+
+	// the stacks the batch added or topped up
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory Batch Add Summary")
+	FInventoryChangeSummary Changes;
+};
+
+// called immediately after a batched add (even before BeginPlay), once per batch
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryBatchAdded, const FInventoryBatchAddSummary&, BatchSummary);
+
+// an inventory's stacks of one item class
+struct FItemClassStacks
+{
+	FItemClassStacks()
+	{
+		TotalQuantity = 0;
+	}
+
+	// every stack's ID, in the order added
+	TArray<int32, TInlineAllocator<1>> StackIds;
+
+	// stacks below the class's max stack size; adds top these up (most recent first) before starting new stacks
+	TArray<int32, TInlineAllocator<1>> OpenStackIds;
+
+	// summed over StackIds
+	int32 TotalQuantity;
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ACTIONRPGPROJECT_API UInventoryComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
 	friend class UItem;
+	friend struct FItemStack;
+	friend struct FItemStackList;
 
 public:	
 	// Sets default values for this component's properties
 	UInventoryComponent();
 
+	// broadcast at most once per frame, at end of frame, after any change (except batched adds; see OnInventoryBatchAdded)
 	UPROPERTY(BlueprintAssignable, Category = "Inventory")
 	FOnInventoryUpdated OnInventoryUpdated;
 
+	// broadcast alongside OnInventoryUpdated, with what changed
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryChanged OnInventoryChanged;
+
+	/* broadcast by TryAddItemsBatch as soon as the batch is applied. a batch's only notification: its changes aren't repeated in the
+	end-of-frame OnInventoryChanged/OnInventoryUpdated */
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryBatchAdded OnInventoryBatchAdded;
+
+	// only ticks (at end of frame) while changes are pending; broadcasts them
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 protected:
 
+	virtual void BeginPlay() override;
+
 	// maximum weight inventory can hold
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
 	float WeightCapacity;
@@ -104,8 +323,13 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = 0, ClampMax = 200))
 	int32 Capacity;
 
-	UPROPERTY(ReplicatedUsing = OnRep_Items, VisibleAnywhere, Category = "Inventory")
-	TArray<class UItem*> Items;
+	virtual void PostInitProperties() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// contents, by value. order is unspecified (removal swaps the last stack into the gap); use stack IDs to track a stack
+	UPROPERTY(Replicated, VisibleAnywhere, Category = "Inventory")
+	FItemStackList StackList;
 
 public:
 	
@@ -121,6 +345,26 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	FItemAddResult TryAddItemFromClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity);
 
+	/*adds several items to the inventory (i.e., a loot roll) in order. the whole batch is validated against capacity and weight up front
+	(from class defaults; no item objects are created), then applied, and OnInventoryBatchAdded is broadcast with the per-entry results
+	@return: the add result for each entry, in entry order*/
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<FItemAddResult> TryAddItemsBatch(const TArray<FItemBatchEntry>& Entries);
+
+	/*moves up to Quantity of Item (one of Source's items) into Destination, validating once. the stack data moves rather than being
+	duplicated; when a whole stack lands in a new stack, its item object moves with it. each inventory gets its one end-of-frame update
+	@return: the add result on Destination; ActualAmountGiven is also the amount taken from Source*/
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	static FItemAddResult TransferItem(UInventoryComponent* Source, UInventoryComponent* Destination, class UItem* Item, const int32 Quantity);
+
+	// as TransferItem, by stack ID
+	static FItemAddResult TransferStack(UInventoryComponent* Source, UInventoryComponent* Destination, const int32 StackId, const int32 Quantity);
+
+	/*transfers every stack in Source to Destination ("take all"); stacks that don't fit stay in Source
+	@return: the add result for each of Source's stacks*/
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	static TArray<FItemAddResult> TransferAllItems(UInventoryComponent* Source, UInventoryComponent* Destination);
+
 	// takes some quantity aware from the item. removes item from inventory when quantity reaches zero
 	int32 ConsumeItem(class UItem* Item);
 	int32 ConsumeItem(class UItem* Item, const int32 Quantity);
@@ -129,7 +373,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	bool RemoveItem(class UItem* Item);
 
-	// returns true if we have a given amount of an item
+	// returns true if we have a given amount of an item, across all of its stacks
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	bool HasItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity = 1) const;
 
@@ -141,13 +385,47 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	UItem* FindItemByClass(TSubclassOf<class UItem> ItemClass) const;
 
-	// get all inventory items that are a child of ItemClass. useful for getting all Weapons, all Consumables, etc
+	// get all inventory items that are a child of ItemClass. useful for getting all Weapons, all Gear, etc
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	TArray<UItem*> FindItemsByClass(TSubclassOf<class UItem> ItemClass) const;
 
-	// returns the current weight of the inventory. to get the amount of items in the inventory, use GetItems().Num()
+	// get all inventory items in the given category, in the order they were added
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<UItem*> FindItemsByCategory(const EItemCategory Category) const;
+
+	// the IDs of the given category's stacks, in the order they were added. valid until the inventory next changes
+	const TArray<int32>& GetStackIdsInCategory(const EItemCategory Category) const;
+
+	// the category an item of this class is sorted into
+	static EItemCategory GetItemCategory(const UClass* ItemClass);
+
+	// get all inventory items in the given view's order; the order is kept up to date as items change, so nothing is sorted here
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<UItem*> GetSortedItems(const EInventorySortView View) const;
+
+	// as GetSortedItems, only including items in the given category
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<UItem*> GetSortedItemsInCategory(const EInventorySortView View, const EItemCategory Category) const;
+
+	// every stack's ID, in the given view's order. valid until the inventory next changes
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	const TArray<int32>& GetSortedStackIds(const EInventorySortView View) const;
+
+	// returns the item object for the given stack, creating it if it doesn't exist yet. null if there's no such stack
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	UItem* GetItemForStack(const int32 StackId) const;
+
+	// the stack with the given ID, if any. valid until the inventory next changes
+	const FItemStack* FindStack(const int32 StackId) const;
+
+	// the first stack of exactly ItemClass, if any. valid until the inventory next changes
+	const FItemStack* FindStackByClass(const UClass* ItemClass) const;
+
+	FORCEINLINE const TArray<FItemStack>& GetStacks() const { return StackList.Items; }
+
+	// returns the current weight of the inventory. to get the amount of items in the inventory, use GetNumStacks()
 	UFUNCTION(BlueprintPure, Category = "Inventory")
-	float GetCurrentWeight() const;
+	FORCEINLINE float GetCurrentWeight() const { return CurrentWeight; }
 
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	void SetWeightCapacity(const float NewWeightCapacity);
@@ -162,24 +440,124 @@ public:
 	FORCEINLINE int32 GetCapacity() const { return Capacity; }
 
 	UFUNCTION(BlueprintPure, Category = "Inventory")
-	FORCEINLINE TArray<class UItem*> GetItems() const { return Items; }
+	FORCEINLINE int32 GetNumStacks() const { return StackList.Items.Num(); }
+
+	// every inventory item, materializing any that don't exist yet. native code should read GetStacks() instead
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<class UItem*> GetItems() const;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Inventory")
 	TArray<FName> PickupsTaken;
 
+	/* async-load every held item's presentation assets (thumbnails, pickup sounds, gear meshes), ahead of the inventory being shown
+	(i.e., chest focused, menu opened). they stay loaded until ReleasePresentationAssets() or the next prefetch */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void PrefetchPresentationAssets();
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void ReleasePresentationAssets();
+
 
 private:
 
-	UFUNCTION()
-	void OnRep_Items();
+	// client-side replication: per-stack callbacks feed the change summary; indices are rebuilt once the whole update is in
+	void OnStackReplicatedRemove(const FItemStack& Stack);
+	void OnStackReplicatedAdd(const FItemStack& Stack);
+	void OnStackReplicatedChange(const FItemStack& Stack);
+	void OnStacksReplicated();
 
-	UPROPERTY()
-	int32 ReplicatedItemsKey;
+	int32 NextStackId;
+
+	// stack ID -> index in StackList
+	TMap<int32, int32> StackIndices;
+
+	// stacks keyed by exact item class; kept in step with StackList so class lookups (and finding a stack with room) are a single hash probe
+	TMap<const UClass*, FItemClassStacks> ItemClassIndex;
+
+	// every stack's ID, bucketed by category in the order added, so category queries needn't filter StackList
+	TArray<int32> CategoryBuckets[(uint8)EItemCategory::EIC_MAX];
+
+	// every stack's ID, in each view's order; a stack is inserted at its place when added, and moved when its quantity changes its weight
+	TArray<int32> SortedViews[(uint8)EInventorySortView::EISV_MAX];
+
+	// strict ordering within a view (falling back to name, then stack ID)
+	static bool IsStackSortedBefore(const EInventorySortView View, const FItemStack& A, const FItemStack& B);
+
+	void InsertIntoSortedView(const EInventorySortView View, const int32 StackId);
+
+	// rebuild the stack, class and category indices from scratch (i.e., after a replication update)
+	void RebuildStackIndices();
+
+	// index in StackList, or INDEX_NONE
+	int32 FindStackIndex(const int32 StackId) const;
+	int32 FindStackIndexByClass(const UClass* ItemClass) const;
+	int32 FindStackIndexForItem(const class UItem* Item) const;
+
+	// creates (once) and returns the stack's item object
+	UItem* MaterializeItem(const FItemStack& Stack) const;
+
+	TArray<UItem*> MaterializeItems(const TArray<int32>& StackIds) const;
+
+	// running total of every stack's weight; updated on add, remove, and quantity change
+	float CurrentWeight;
+
+	// sums stack weights from scratch
+	float CalculateCurrentWeight() const;
+
+	// called by a materialized item whenever its quantity is set directly (i.e., from Blueprint)
+	void OnItemQuantityChanged(const class UItem* Item);
+
+#if DO_GUARD_SLOW
+	// debug builds only: recompute the weight from scratch and flag any drift from the running total
+	void ValidateCurrentWeight() const;
+#endif
 	
-	// do not call Items.Add() directly, use this function instead
-	UItem* AddItem(class UItem* Item);
+	TSharedPtr<FStreamableHandle> PresentationAssetsHandle;
+
+	// changes since the last broadcast
+	UPROPERTY()
+	FInventoryChangeSummary PendingChanges;
 
-	// internal, non-BP exposed add item function. not to be called directly; use TryAddItem() or TryAddItemFromClass() instead
-	FItemAddResult TryAddItem_Internal(class UItem* Item);
+	bool bChangesPending;
 
-};
+	// flag a change for the end-of-frame broadcast (enables tick until then)
+	void MarkChangesPending();
+
+	void MarkStackAdded(const int32 StackId);
+	void MarkStackRemoved(const int32 StackId);
+	void MarkStackModified(const int32 StackId);
+
+	// the only way quantity changes; keeps weight, the materialized item and the change summary in step
+	void SetStackQuantity(FItemStack& Stack, const int32 NewQuantity);
+
+	// bookkeeping shared by SetStackQuantity() and OnItemQuantityChanged(), once Stack holds its new quantity
+	void OnStackQuantityChanged(FItemStack& Stack, const int32 OldQuantity);
+
+	// adds/removes the stack from its class's open stacks to match its quantity
+	void UpdateOpenStack(FItemClassStacks& ClassStacks, const FItemStack& Stack);
+
+	/* do not call StackList.Items.Add() directly, use this function instead. Item may be a class default object; it's only read.
+	InstanceToAdopt, if given, is an item object transferred from another inventory, which becomes the new stack's item. returns the new stack's index */
+	int32 AddStack(const class UItem* Item, const int32 Quantity, class UItem* InstanceToAdopt = nullptr);
+
+	// do not call StackList.Items.RemoveAt() directly, use this function instead
+	void RemoveStackAt(const int32 StackIndex);
+
+	// AddedToInventory notification (hud message, sound, auto-equip) for quantity added to a stack
+	void NotifyStackAdded(const int32 StackIndex, const int32 QuantityAdded);
+
+	/* how much of each entry fits, given everything before it in the batch, without changing anything. entries that don't fit in full
+	get an AddedSome/AddedNone result with the reason; OutAmounts holds the amount of each entry to add */
+	void PlanBatchAdd(const TArray<FItemBatchEntry>& Entries, TArray<int32>& OutAmounts, TArray<FItemAddResult>& OutResults) const;
+
+	// how much of Amount fits under the weight capacity, already carrying CarriedWeight. shared by TryAddItem_Internal() and PlanBatchAdd(), so they agree
+	int32 GetWeightLimitedAmount(const class UItem* Item, const int32 Amount, const float CarriedWeight) const;
+
+	/* internal, non-BP exposed add item function: checks capacity and weight, then adds what fits (see AddToStacks).
+	not to be called directly; use TryAddItem(), TryAddItemFromClass() or TryAddItemsBatch() instead */
+	FItemAddResult TryAddItem_Internal(const class UItem* Item, const int32 AddAmount, class UItem* InstanceToAdopt = nullptr);
+
+	// tops up the class's open stacks, then spills the rest into new stacks while capacity allows. no weight check; returns the amount added
+	int32 AddToStacks(const class UItem* Item, const int32 Amount, class UItem* InstanceToAdopt = nullptr);
+
+};
\ No newline at end of file
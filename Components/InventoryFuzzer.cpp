@@ -0,0 +1,365 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "../Components/InventoryComponent.h"
+#include "../Items/Item.h"
+
+#if !UE_BUILD_SHIPPING
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectIterator.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/AssetData.h"
+#endif
+
+/**
+ *  runs a random sequence of adds, consumes, removes, capacity changes and loot transfers against a full (200-stack) inventory.
+ *  in the editor, every item Blueprint in the project is loaded to take part; elsewhere, only item classes already loaded do
+ *
+ *  Inventory.Fuzz [NumOperations] [Seed]
+ *  benchmark: logs operations per second and allocations per operation, so inventory changes have a baseline to compare against
+ *
+ *  ActionRPGProject.Inventory.Fuzz (automation test)
+ *  checks the inventory's invariants after every operation, and fails on any violation
+ */
+
+namespace InventoryFuzzer
+{
+	const int32 FullCapacity = 200;
+
+	// allocator calls made so far, process-wide (other threads' allocations land in the count too, so treat it as an upper bound).
+	// read rather than hooked, so nothing is installed over GMalloc; stays at zero with allocators that don't keep the count
+	uint64 GetAllocationCount()
+	{
+		return FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+	}
+
+	enum class EOperation : uint8
+	{
+		AddFromClass,
+		AddItem,
+		Consume,
+		Remove,
+		ChangeCapacity,
+		Transfer,
+		TransferAll,
+
+		MAX
+	};
+
+	struct FRunResult
+	{
+		int32 NumOperations = 0;
+		int32 NumItemClasses = 0;
+
+		// classes that stack and have weight, i.e. that exercise stack spills and the weight limit
+		int32 NumStackableWeightedClasses = 0;
+		int32 NumViolations = 0;
+		double OperationSeconds = 0.0;
+		uint64 NumAllocations = 0;
+		int32 OperationCounts[(uint8)EOperation::MAX] = {};
+	};
+
+	// relative odds of each operation being picked
+	const int32 OperationWeights[(uint8)EOperation::MAX] = { 30, 15, 20, 10, 5, 15, 5 };
+
+	const TCHAR* GetOperationName(const EOperation Operation)
+	{
+		switch (Operation)
+		{
+		case EOperation::AddFromClass: return TEXT("TryAddItemFromClass");
+		case EOperation::AddItem: return TEXT("TryAddItem");
+		case EOperation::Consume: return TEXT("ConsumeItem");
+		case EOperation::Remove: return TEXT("RemoveItem");
+		case EOperation::ChangeCapacity: return TEXT("SetCapacity");
+		case EOperation::Transfer: return TEXT("TransferItem");
+		case EOperation::TransferAll: return TEXT("TransferAllItems");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	EOperation PickOperation(FRandomStream& Random)
+	{
+		int32 TotalWeight = 0;
+
+		for (const int32 Weight : OperationWeights)
+		{ TotalWeight += Weight; }
+
+		int32 Roll = Random.RandRange(0, TotalWeight - 1);
+
+		for (uint8 i = 0; i < (uint8)EOperation::MAX; ++i)
+		{
+			if (Roll < OperationWeights[i])
+			{ return (EOperation)i; }
+
+			Roll -= OperationWeights[i];
+		}
+
+		return EOperation::AddFromClass;
+	}
+
+	// a random stack's item, or null if the inventory is empty
+	UItem* PickItem(UInventoryComponent* Inventory, FRandomStream& Random)
+	{
+		const TArray<FItemStack>& Stacks = Inventory->GetStacks();
+		return Stacks.Num() > 0 ? Inventory->GetItemForStack(Stacks[Random.RandRange(0, Stacks.Num() - 1)].StackId) : nullptr;
+	}
+
+	// the invariants the inventory ensures as it goes; logs each one violated and returns how many were
+	int32 CheckInvariants(const UInventoryComponent* Inventory, const int32 OperationIndex, const EOperation Operation)
+	{
+		int32 NumViolations = 0;
+
+		auto ReportViolation = [&](const FString& Description)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Inventory.Fuzz: after operation %d (%s) on %s: %s"), OperationIndex, GetOperationName(Operation), *Inventory->GetName(), *Description);
+			++NumViolations;
+		};
+
+		const TArray<FItemStack>& Stacks = Inventory->GetStacks();
+		float CalculatedWeight = 0.0f;
+
+		if (Stacks.Num() > Inventory->GetCapacity())
+		{ ReportViolation(FString::Printf(TEXT("%d stacks in a %d-stack inventory"), Stacks.Num(), Inventory->GetCapacity())); }
+
+		for (const FItemStack& Stack : Stacks)
+		{
+			if (Stack.Quantity <= 0)
+			{ ReportViolation(FString::Printf(TEXT("stack %d has quantity %d"), Stack.StackId, Stack.Quantity)); }
+
+			if (Stack.Quantity > Stack.GetMaxStackSize())
+			{ ReportViolation(FString::Printf(TEXT("stack %d has quantity %d, over its max stack size of %d"), Stack.StackId, Stack.Quantity, Stack.GetMaxStackSize())); }
+
+			if (Inventory->FindStack(Stack.StackId) != &Stack)
+			{ ReportViolation(FString::Printf(TEXT("stack %d isn't indexed"), Stack.StackId)); }
+
+			if (Stack.Instance && (Stack.Instance->GetQuantity() != Stack.Quantity || Stack.Instance->OwningInventory != Inventory))
+			{ ReportViolation(FString::Printf(TEXT("stack %d's item is out of step with it"), Stack.StackId)); }
+
+			CalculatedWeight += Stack.GetStackWeight();
+		}
+
+		// allow for float drift accumulated over many adds/removes
+		if (!FMath::IsNearlyEqual(Inventory->GetCurrentWeight(), CalculatedWeight, 0.01f))
+		{ ReportViolation(FString::Printf(TEXT("running weight %f doesn't match calculated weight %f"), Inventory->GetCurrentWeight(), CalculatedWeight)); }
+
+		if (CalculatedWeight > Inventory->GetWeightCapacity() + 0.01f)
+		{ ReportViolation(FString::Printf(TEXT("weight %f is over the weight capacity of %f"), CalculatedWeight, Inventory->GetWeightCapacity())); }
+
+		for (uint8 View = 0; View < (uint8)EInventorySortView::EISV_MAX; ++View)
+		{
+			if (Inventory->GetSortedStackIds((EInventorySortView)View).Num() != Stacks.Num())
+			{ ReportViolation(FString::Printf(TEXT("sort view %d has %d of %d stacks"), View, Inventory->GetSortedStackIds((EInventorySortView)View).Num(), Stacks.Num())); }
+		}
+
+		return NumViolations;
+	}
+
+	// every instantiable item class (loading the project's item Blueprints first, in the editor)
+	TArray<UClass*> GatherItemClasses()
+	{
+#if WITH_EDITOR
+		TArray<FAssetData> ItemBlueprintAssets;
+		UItem::GetItemBlueprintAssets(ItemBlueprintAssets);
+
+		for (const FAssetData& ItemBlueprintAsset : ItemBlueprintAssets)
+		{ ItemBlueprintAsset.GetAsset(); }
+#endif
+
+		TArray<UClass*> ItemClasses;
+
+		for (TObjectIterator<UClass> It; It; ++It)
+		{
+			if (It->IsChildOf(UItem::StaticClass()) && !It->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists)
+				&& !It->GetName().StartsWith(TEXT("SKEL_")) && !It->GetName().StartsWith(TEXT("REINST_")))
+			{ ItemClasses.Add(*It); }
+		}
+
+		return ItemClasses;
+	}
+
+	UInventoryComponent* SpawnInventory(UWorld* World)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags = RF_Transient;
+
+		AActor* InventoryOwner = World->SpawnActor<AActor>(SpawnParams);
+		UInventoryComponent* Inventory = NewObject<UInventoryComponent>(InventoryOwner);
+		Inventory->RegisterComponent();
+		Inventory->SetCapacity(FullCapacity);
+
+		return Inventory;
+	}
+
+	/* performs NumOperations random operations (against two inventories spawned in World, destroyed afterwards), timing each one and
+	counting its allocations. with bCheckInvariants, both inventories are checked after every operation (outside the timing) */
+	FRunResult RunOperations(UWorld* World, const int32 NumOperations, const int32 Seed, const bool bCheckInvariants)
+	{
+		FRunResult Result;
+		FRandomStream Random(Seed);
+
+		const TArray<UClass*> ItemClasses = GatherItemClasses();
+		Result.NumItemClasses = ItemClasses.Num();
+
+		for (const UClass* ItemClass : ItemClasses)
+		{
+			const UItem* ItemDefaults = ItemClass->GetDefaultObject<UItem>();
+
+			if (ItemDefaults->GetMaxStackSize() > 1 && !FMath::IsNearlyZero(ItemDefaults->GetWeight()))
+			{ ++Result.NumStackableWeightedClasses; }
+		}
+
+		if (!World || ItemClasses.Num() == 0)
+		{ return Result; }
+
+		// reusable TryAddItem() arguments, one per class
+		TArray<UItem*> ItemTemplates;
+
+		for (UClass* ItemClass : ItemClasses)
+		{ ItemTemplates.Add(NewObject<UItem>(GetTransientPackage(), ItemClass)); }
+
+		UInventoryComponent* PlayerInventory = SpawnInventory(World);
+		UInventoryComponent* LootInventory = SpawnInventory(World);
+
+		// start full: fill both inventories to capacity (as far as the loaded classes' stack sizes allow), then cap weight near the load
+		for (UInventoryComponent* Inventory : { PlayerInventory, LootInventory })
+		{
+			Inventory->SetWeightCapacity(BIG_NUMBER);
+
+			for (int32 Attempt = 0; Attempt < FullCapacity * 4 && Inventory->GetNumStacks() < FullCapacity; ++Attempt)
+			{ Inventory->TryAddItemFromClass(ItemClasses[Random.RandRange(0, ItemClasses.Num() - 1)], Random.RandRange(1, 10)); }
+
+			Inventory->SetWeightCapacity(Inventory->GetCurrentWeight() * 1.25f + 10.0f);
+		}
+
+		for (int32 i = 0; i < NumOperations; ++i)
+		{
+			const EOperation Operation = PickOperation(Random);
+			const bool bToPlayer = Random.FRand() < 0.75f;
+			UInventoryComponent* Inventory = bToPlayer ? PlayerInventory : LootInventory;
+			UInventoryComponent* OtherInventory = bToPlayer ? LootInventory : PlayerInventory;
+
+			// picked before timing starts; materializing the picked item is counted, as it's part of what the game does
+			const int32 ClassIndex = Random.RandRange(0, ItemClasses.Num() - 1);
+			const int32 Quantity = Random.RandRange(1, 2 * ItemClasses[ClassIndex]->GetDefaultObject<UItem>()->GetMaxStackSize());
+			const float CapacityRoll = Random.FRand();
+
+			++Result.OperationCounts[(uint8)Operation];
+			const uint64 StartAllocations = GetAllocationCount();
+			const double StartSeconds = FPlatformTime::Seconds();
+
+			switch (Operation)
+			{
+			case EOperation::AddFromClass:
+				Inventory->TryAddItemFromClass(ItemClasses[ClassIndex], Quantity);
+				break;
+
+			case EOperation::AddItem:
+				ItemTemplates[ClassIndex]->SetQuantity(Quantity);
+				Inventory->TryAddItem(ItemTemplates[ClassIndex]);
+				break;
+
+			case EOperation::Consume:
+				if (UItem* Item = PickItem(Inventory, Random))
+				{ Inventory->ConsumeItem(Item, Random.RandRange(1, Item->GetQuantity())); }
+				break;
+
+			case EOperation::Remove:
+				if (UItem* Item = PickItem(Inventory, Random))
+				{ Inventory->RemoveItem(Item); }
+				break;
+
+			case EOperation::ChangeCapacity:
+				// never below what's already held, so the invariants stay meaningful
+				Inventory->SetCapacity(FMath::Clamp(Inventory->GetNumStacks() + FMath::RoundToInt(CapacityRoll * 10.0f), 1, FullCapacity));
+				Inventory->SetWeightCapacity(Inventory->GetCurrentWeight() + CapacityRoll * 50.0f);
+				break;
+
+			case EOperation::Transfer:
+				if (UItem* Item = PickItem(OtherInventory, Random))
+				{ UInventoryComponent::TransferItem(OtherInventory, Inventory, Item, Random.RandRange(1, Item->GetQuantity())); }
+				break;
+
+			case EOperation::TransferAll:
+				UInventoryComponent::TransferAllItems(OtherInventory, Inventory);
+				break;
+
+			default:
+				break;
+			}
+
+			Result.OperationSeconds += FPlatformTime::Seconds() - StartSeconds;
+			Result.NumAllocations += GetAllocationCount() - StartAllocations;
+
+			if (bCheckInvariants)
+			{
+				Result.NumViolations += CheckInvariants(PlayerInventory, i, Operation);
+				Result.NumViolations += CheckInvariants(LootInventory, i, Operation);
+			}
+		}
+
+		Result.NumOperations = NumOperations;
+
+		PlayerInventory->GetOwner()->Destroy();
+		LootInventory->GetOwner()->Destroy();
+
+		return Result;
+	}
+
+	void RunBenchmark(const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 NumOperations = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000;
+		const int32 Seed = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : (int32)FPlatformTime::Cycles();
+
+		const FRunResult Result = RunOperations(World, NumOperations, Seed, false);
+
+		if (Result.NumItemClasses == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Inventory.Fuzz: no item classes found"));
+			return;
+		}
+
+		for (uint8 i = 0; i < (uint8)EOperation::MAX; ++i)
+		{ UE_LOG(LogTemp, Log, TEXT("Inventory.Fuzz:   %s x%d"), GetOperationName((EOperation)i), Result.OperationCounts[i]); }
+
+		UE_LOG(LogTemp, Log, TEXT("Inventory.Fuzz: %d operations (seed %d, %d item classes, %d stackable and weighted) in %.3fs: %.0f operations/sec, %.2f allocations/operation"),
+			Result.NumOperations, Seed, Result.NumItemClasses, Result.NumStackableWeightedClasses, Result.OperationSeconds, Result.OperationSeconds > 0.0 ? Result.NumOperations / Result.OperationSeconds : 0.0,
+			Result.NumOperations > 0 ? (double)Result.NumAllocations / Result.NumOperations : 0.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs InventoryFuzzCommand(
+	TEXT("Inventory.Fuzz"),
+	TEXT("Inventory.Fuzz [NumOperations] [Seed]: run random inventory operations against a full inventory, logging throughput/allocations"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&InventoryFuzzer::RunBenchmark));
+
+#if WITH_DEV_AUTOMATION_TESTS
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryFuzzTest, "ActionRPGProject.Inventory.Fuzz", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryFuzzTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	// fixed seed, so a failure reproduces
+	const InventoryFuzzer::FRunResult Result = InventoryFuzzer::RunOperations(World, 20000, 0x1A7E, true);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	TestTrue(TEXT("At least one item class"), Result.NumItemClasses > 0);
+
+	// without one, the spill and weight-limit paths barely run (the native classes are weightless, in stacks of 2)
+	TestTrue(TEXT("At least one stackable, weighted item class"), Result.NumStackableWeightedClasses > 0);
+	TestEqual(TEXT("Invariant violations"), Result.NumViolations, 0);
+
+	return true;
+}
+#endif
+#endif
\ No newline at end of file
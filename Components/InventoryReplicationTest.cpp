@@ -0,0 +1,345 @@
+// © 2022 Andrew Creekmore
+
+
+#include "../Character/Main.h"
+#include "../Components/InventoryComponent.h"
+#include "../Items/Item.h"
+
+#if WITH_EDITOR && WITH_DEV_AUTOMATION_TESTS
+#include "Editor.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationEditorCommon.h"
+
+/**
+ *  ActionRPGProject.Inventory.ReplicationCost (automation test)
+ *  loads the test map and plays it as a listen server with one client, fills the client's inventory on the server, then makes one
+ *  small change (a single stack's quantity) per frame, and then loots a container into it with TransferAllItems ("take all"),
+ *  measuring with the server net driver's byte counters what each costs to replicate over an idle baseline. fails if either is over
+ *  budget, or if the client ends up out of step with the server
+ */
+
+namespace InventoryReplicationTest
+{
+	// a small, empty map whose game mode spawns AMain players; kept apart from the game's maps, so the test loads quickly and the same way each run
+	const TCHAR* TestMapName = TEXT("/Game/Maps/Tests/InventoryReplicationTest");
+
+	// stacks in the client's inventory while changes are measured
+	const int32 NumStacks = 100;
+
+	// frames measured, idle and then with one change per frame
+	const int32 MeasureFrames = 100;
+
+	// frames given to replication to catch up after filling the inventory, after the last change, and after looting
+	const int32 SettleFrames = 60;
+
+	// stacks (of 2) in the looted container; each looted item tops up one of the client's stacks, so is one change
+	const int32 NumLootStacks = 20;
+
+	const double SessionTimeoutSeconds = 30.0;
+
+	/* a quantity change is a fast array item delta (item ID plus the changed property) and some bunch overhead; a resend of every stack
+	would run over a kilobyte */
+	const double MaxBytesPerChange = 96.0;
+
+	enum class EPhase : uint8
+	{
+		WaitForSession,
+		Fill,
+		Settle,
+		MeasureIdle,
+		MeasureChanges,
+		SettleChanges,
+		MeasureLoot,
+		Done
+	};
+
+	class FMeasureReplicationCostCommand : public IAutomationLatentCommand
+	{
+	public:
+
+		FMeasureReplicationCostCommand(FAutomationTestBase* InTest)
+		{
+			Test = InTest;
+			Phase = EPhase::WaitForSession;
+			StartSeconds = FPlatformTime::Seconds();
+			PhaseFrames = 0;
+			PhaseStartBytes = 0;
+			IdleBytes = 0;
+		}
+
+		virtual bool Update() override
+		{
+			if (Phase == EPhase::WaitForSession)
+			{
+				if (!FindSession())
+				{
+					if (FPlatformTime::Seconds() - StartSeconds > SessionTimeoutSeconds)
+					{
+						Test->AddError(TEXT("Listen server and client never both had an AMain with an inventory"));
+						return true;
+					}
+
+					return false;
+				}
+
+				Phase = EPhase::Fill;
+			}
+
+			if (!ServerInventory.IsValid() || !ClientInventory.IsValid() || !ServerDriver.IsValid())
+			{
+				Test->AddError(TEXT("The play session ended before the measurement finished"));
+				return true;
+			}
+
+			switch (Phase)
+			{
+			case EPhase::Fill:
+				{
+					// the native item class falls back to the default definition: weightless, stacks of 2
+					ServerInventory->SetCapacity(ServerInventory->GetNumStacks() + NumStacks);
+					ServerInventory->SetWeightCapacity(BIG_NUMBER);
+					ServerInventory->TryAddItemFromClass(UItem::StaticClass(), NumStacks * 2);
+
+					for (const FItemStack& Stack : ServerInventory->GetStacks())
+					{
+						if (Stack.ItemClass == UItem::StaticClass() && Stack.Quantity == 2)
+						{ ChangeStackIds.Add(Stack.StackId); }
+					}
+
+					if (!Test->TestTrue(TEXT("Enough stacks to change one per frame"), ChangeStackIds.Num() >= MeasureFrames))
+					{ return true; }
+
+					StartPhase(EPhase::Settle);
+					break;
+				}
+
+			case EPhase::Settle:
+				if (PhaseFrames >= SettleFrames)
+				{ StartPhase(EPhase::MeasureIdle); }
+				break;
+
+			case EPhase::MeasureIdle:
+				if (PhaseFrames >= MeasureFrames)
+				{
+					IdleBytes = GetBytesSent() - PhaseStartBytes;
+					StartPhase(EPhase::MeasureChanges);
+				}
+				break;
+
+			case EPhase::MeasureChanges:
+				if (PhaseFrames < MeasureFrames)
+				{
+					// one small change per frame: a single stack's quantity, 2 -> 1
+					if (UItem* Item = ServerInventory->GetItemForStack(ChangeStackIds[PhaseFrames]))
+					{ ServerInventory->ConsumeItem(Item, 1); }
+				}
+
+				else
+				{
+					const uint64 ChangeBytes = GetBytesSent() - PhaseStartBytes;
+					const double BytesPerChange = ((double)ChangeBytes - (double)IdleBytes) / MeasureFrames;
+
+					UE_LOG(LogTemp, Log, TEXT("Inventory.ReplicationCost: %llu bytes idle, %llu bytes with %d changes over %d frames: %.1f bytes/change"),
+						IdleBytes, ChangeBytes, MeasureFrames, MeasureFrames, BytesPerChange);
+
+					Test->TestTrue(FString::Printf(TEXT("Bytes per change (%.1f) within budget (%.0f)"), BytesPerChange, MaxBytesPerChange), BytesPerChange <= MaxBytesPerChange);
+
+					StartPhase(EPhase::SettleChanges);
+				}
+				break;
+
+			case EPhase::SettleChanges:
+				if (PhaseFrames >= SettleFrames)
+				{
+					StartPhase(EPhase::MeasureLoot);
+
+					if (!Loot())
+					{ return true; }
+				}
+				break;
+
+			case EPhase::MeasureLoot:
+				if (PhaseFrames >= SettleFrames)
+				{
+					// all in one frame, so cheaper per change than one change per frame would be; the idle baseline is scaled to this phase's length
+					const uint64 LootBytes = GetBytesSent() - PhaseStartBytes;
+					const double BytesPerLootChange = ((double)LootBytes - (double)IdleBytes * SettleFrames / MeasureFrames) / (NumLootStacks * 2);
+
+					UE_LOG(LogTemp, Log, TEXT("Inventory.ReplicationCost: %llu bytes over %d frames looting %d stacks: %.1f bytes/change"),
+						LootBytes, SettleFrames, NumLootStacks, BytesPerLootChange);
+
+					Test->TestTrue(FString::Printf(TEXT("Bytes per looted change (%.1f) within budget (%.0f)"), BytesPerLootChange, MaxBytesPerChange), BytesPerLootChange <= MaxBytesPerChange);
+
+					Test->TestEqual(TEXT("Client stack count"), ClientInventory->GetNumStacks(), ServerInventory->GetNumStacks());
+					Test->TestEqual(TEXT("Client quantity of changed item"), CountQuantity(ClientInventory.Get()), CountQuantity(ServerInventory.Get()));
+
+					Phase = EPhase::Done;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			++PhaseFrames;
+			return Phase == EPhase::Done;
+		}
+
+	private:
+
+		FAutomationTestBase* Test;
+		EPhase Phase;
+		double StartSeconds;
+
+		int32 PhaseFrames;
+		uint64 PhaseStartBytes;
+		uint64 IdleBytes;
+
+		TWeakObjectPtr<UNetDriver> ServerDriver;
+		TWeakObjectPtr<UInventoryComponent> ServerInventory;
+		TWeakObjectPtr<UInventoryComponent> ClientInventory;
+
+		TArray<int32> ChangeStackIds;
+
+		// bytes the server has sent to its clients so far
+		uint64 GetBytesSent() const
+		{
+			return ServerDriver->OutTotalBytes;
+		}
+
+		void StartPhase(const EPhase NewPhase)
+		{
+			Phase = NewPhase;
+			PhaseFrames = -1;
+			PhaseStartBytes = GetBytesSent();
+		}
+
+		/* fills a container (an unreplicated actor on the server, as only the looter's inventory should cost anything) and takes all of it
+		into the client's inventory ("take all"). every stack the changes left at 1 has room for one more, so each looted item tops one up */
+		bool Loot()
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.ObjectFlags = RF_Transient;
+
+			AActor* Container = ServerInventory->GetWorld()->SpawnActor<AActor>(SpawnParams);
+			UInventoryComponent* LootInventory = NewObject<UInventoryComponent>(Container);
+			LootInventory->RegisterComponent();
+			LootInventory->SetCapacity(NumLootStacks);
+			LootInventory->SetWeightCapacity(BIG_NUMBER);
+			LootInventory->TryAddItemFromClass(UItem::StaticClass(), NumLootStacks * 2);
+
+			const bool bFilled = Test->TestEqual(TEXT("Looted container's stacks"), LootInventory->GetNumStacks(), NumLootStacks);
+
+			if (bFilled)
+			{
+				UInventoryComponent::TransferAllItems(LootInventory, ServerInventory.Get());
+				Test->TestEqual(TEXT("Stacks left in the looted container"), LootInventory->GetNumStacks(), 0);
+			}
+
+			Container->Destroy();
+			return bFilled;
+		}
+
+		static int32 CountQuantity(const UInventoryComponent* Inventory)
+		{
+			int32 TotalQuantity = 0;
+
+			for (const FItemStack& Stack : Inventory->GetStacks())
+			{
+				if (Stack.ItemClass == UItem::StaticClass())
+				{ TotalQuantity += Stack.Quantity; }
+			}
+
+			return TotalQuantity;
+		}
+
+		// the listen server's net driver and its remote player's inventory, and that same inventory on the client
+		bool FindSession()
+		{
+			UWorld* ServerWorld = nullptr;
+			UWorld* ClientWorld = nullptr;
+
+			for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+			{
+				UWorld* World = WorldContext.World();
+
+				if (WorldContext.WorldType != EWorldType::PIE || !World)
+				{ continue; }
+
+				if (World->GetNetMode() == NM_ListenServer)
+				{ ServerWorld = World; }
+
+				else if (World->GetNetMode() == NM_Client)
+				{ ClientWorld = World; }
+			}
+
+			UNetDriver* NetDriver = ServerWorld ? ServerWorld->GetNetDriver() : nullptr;
+
+			if (!NetDriver || NetDriver->ClientConnections.Num() == 0 || !ClientWorld)
+			{ return false; }
+
+			const UNetConnection* ClientConnection = NetDriver->ClientConnections[0];
+			const AMain* ServerMain = ClientConnection->PlayerController ? Cast<AMain>(ClientConnection->PlayerController->GetPawn()) : nullptr;
+
+			const APlayerController* ClientController = ClientWorld->GetFirstPlayerController();
+			const AMain* ClientMain = ClientController ? Cast<AMain>(ClientController->GetPawn()) : nullptr;
+
+			if (!ServerMain || !ServerMain->PlayerInventory || !ClientMain || !ClientMain->PlayerInventory)
+			{ return false; }
+
+			ServerDriver = NetDriver;
+			ServerInventory = ServerMain->PlayerInventory;
+			ClientInventory = ClientMain->PlayerInventory;
+
+			return true;
+		}
+	};
+
+	// puts the editor's play settings back once the session is over
+	DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FRestorePlaySettingsCommand, EPlayNetMode, SavedNetMode, int32, SavedNumberOfClients);
+
+	bool FRestorePlaySettingsCommand::Update()
+	{
+		ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+		PlaySettings->SetPlayNetMode(SavedNetMode);
+		PlaySettings->SetPlayNumberOfClients(SavedNumberOfClients);
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryReplicationCostTest, "ActionRPGProject.Inventory.ReplicationCost", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryReplicationCostTest::RunTest(const FString& Parameters)
+{
+	// fail up front, rather than waiting out the session timeout on whatever map happens to be open
+	if (!FPackageName::DoesPackageExist(InventoryReplicationTest::TestMapName))
+	{
+		AddError(FString::Printf(TEXT("Test map %s not found"), InventoryReplicationTest::TestMapName));
+		return false;
+	}
+
+	ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+
+	EPlayNetMode SavedNetMode = PIE_Standalone;
+	int32 SavedNumberOfClients = 1;
+	PlaySettings->GetPlayNetMode(SavedNetMode);
+	PlaySettings->GetPlayNumberOfClients(SavedNumberOfClients);
+
+	// the listen server counts as one of the two players
+	PlaySettings->SetPlayNetMode(PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(2);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FEditorLoadMap(InventoryReplicationTest::TestMapName));
+	ADD_LATENT_AUTOMATION_COMMAND(FStartPIECommand(false));
+	ADD_LATENT_AUTOMATION_COMMAND(InventoryReplicationTest::FMeasureReplicationCostCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(InventoryReplicationTest::FRestorePlaySettingsCommand(SavedNetMode, SavedNumberOfClients));
+
+	return true;
+}
+#endif
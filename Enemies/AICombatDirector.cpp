@@ -4,6 +4,9 @@
 #include "AICombatDirector.h"
 #include "../DebugMacros.h"
 #include "../Enemies/Enemy.h"
+#include "../Enemies/EnemyController.h"
+#include "../Enemies/NavArea_EncounterBarrier.h"
+#include "NavModifierComponent.h"
 
 // sets default values
 AAICombatDirector::AAICombatDirector()
@@ -13,12 +16,80 @@ AAICombatDirector::AAICombatDirector()
 	PositionRelativeToCameraWeight = 1.f;
 	AttackRecencyWeight = 1.f;
 	DelayBetweenIssuingAttacks = 4.0f;
+
+	bArenaSealed = false;
 }
 
 // called when the game starts or when spawned
 void AAICombatDirector::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// barriers are configured in the editor (see ConfigureBarriersForNavigation); changing navigation relevance here would rebuild the navmesh
+	for (const AActor* Barrier : AssignedBarriers)
+	{
+		if (!Barrier)
+		{ continue; }
+
+		ensureMsgf(HasEncounterBarrierNavModifier(Barrier), TEXT("%s: barrier %s has no nav modifier with UNavArea_EncounterBarrier; sealing won't restrict enemy pathing"), *GetName(), *Barrier->GetName());
+
+		TInlineComponentArray<UPrimitiveComponent*> BarrierPrimitives(Barrier);
+
+		for (const UPrimitiveComponent* BarrierPrimitive : BarrierPrimitives)
+		{ ensureMsgf(!BarrierPrimitive->CanEverAffectNavigation(), TEXT("%s: barrier %s affects navigation; toggling it will dirty navmesh tiles"), *GetName(), *Barrier->GetName()); }
+	}
+}
+
+
+#if WITH_EDITOR
+void AAICombatDirector::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FName PropertyName = (PropertyChangedEvent.Property != NULL) ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AAICombatDirector, AssignedBarriers))
+	{ ConfigureBarriersForNavigation(); }
+}
+
+
+void AAICombatDirector::ConfigureBarriersForNavigation()
+{
+	for (AActor* Barrier : AssignedBarriers)
+	{
+		if (!Barrier)
+		{ continue; }
+
+		TInlineComponentArray<UPrimitiveComponent*> BarrierPrimitives(Barrier);
+
+		// saved with the level, so the baked navmesh never includes the barriers' collision
+		for (UPrimitiveComponent* BarrierPrimitive : BarrierPrimitives)
+		{
+			if (BarrierPrimitive->CanEverAffectNavigation())
+			{
+				BarrierPrimitive->Modify();
+				BarrierPrimitive->SetCanEverAffectNavigation(false);
+			}
+		}
+
+		if (!HasEncounterBarrierNavModifier(Barrier))
+		{ UE_LOG(LogTemp, Warning, TEXT("%s: barrier %s needs a NavModifier component with area UNavArea_EncounterBarrier"), *GetName(), *Barrier->GetName()); }
+	}
+}
+#endif
+
+
+bool AAICombatDirector::HasEncounterBarrierNavModifier(const AActor* Barrier)
+{
+	TInlineComponentArray<UNavModifierComponent*> NavModifiers(Barrier);
+
+	for (const UNavModifierComponent* NavModifier : NavModifiers)
+	{
+		if (NavModifier->AreaClass && NavModifier->AreaClass->IsChildOf(UNavArea_EncounterBarrier::StaticClass()))
+		{ return true; }
+	}
+
+	return false;
 }
 
 // called every frame
@@ -137,3 +208,55 @@ APawn* AAICombatDirector::FindEnemyWithHighestCombatGrade()
 	return LocalHighestGradedEnemyInstance;
 }
 
+
+
+void AAICombatDirector::SealArena()
+{
+	if (bArenaSealed)
+	{ return; }
+
+	bArenaSealed = true;
+
+	SetBarriersActive(true);
+
+	for (APawn* EnemyInstance : AssignedEnemyList)
+	{ SetEnemyEncounterSealed(EnemyInstance, true); }
+}
+
+
+void AAICombatDirector::UnsealArena()
+{
+	if (!bArenaSealed)
+	{ return; }
+
+	bArenaSealed = false;
+
+	SetBarriersActive(false);
+
+	for (APawn* EnemyInstance : AssignedEnemyList)
+	{ SetEnemyEncounterSealed(EnemyInstance, false); }
+}
+
+
+void AAICombatDirector::SetEnemyEncounterSealed(APawn* EnemyInstance, bool bSealed)
+{
+	if (!EnemyInstance)
+	{ return; }
+
+	if (AEnemyController* EnemyController = Cast<AEnemyController>(EnemyInstance->GetController()))
+	{ EnemyController->SetEncounterSealed(bSealed); }
+}
+
+
+void AAICombatDirector::SetBarriersActive(bool bActive)
+{
+	for (AActor* Barrier : AssignedBarriers)
+	{
+		if (!Barrier)
+		{ continue; }
+
+		// collision only blocks the player (and physics); enemy pathing is handled by the nav filter
+		Barrier->SetActorEnableCollision(bActive);
+		Barrier->SetActorHiddenInGame(!bActive);
+	}
+}
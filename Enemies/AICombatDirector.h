@@ -22,6 +22,14 @@ public:
 	// sets default values for this actor's properties
 	AAICombatDirector();
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	// turns off "Can Ever Affect Navigation" on the assigned barriers' primitives, so toggling them at runtime never dirties the navmesh
+	UFUNCTION(CallInEditor, Category = "Variable Settings")
+	void ConfigureBarriersForNavigation();
+#endif
+
 	// all enemies assigned to this Director instance
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable Settings")
 	TArray<APawn*> AssignedEnemyList;
@@ -30,10 +38,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable Settings")
 	TArray<APawn*> CurrentlyHostileEnemyList;
 
-	// all barriers that have been manually assigned to this Director instance
+	/* all barriers that have been manually assigned to this Director instance. each needs a NavModifier component with area
+	UNavArea_EncounterBarrier; assigning them here configures them not to affect navigation */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable Settings")
 	TArray<AActor*> AssignedBarriers;
 
+	// true while the arena is sealed (barriers up, enemies restricted to the arena side of them)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variable Settings")
+	bool bArenaSealed;
+
 	// map of enemies to float value combat grades
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable Settings")
 	TMap<APawn*, float> EnemyCombatGradesMap;
@@ -75,4 +88,22 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	APawn* FindEnemyWithHighestCombatGrade();
+
+	/* raise the assigned barriers and switch assigned enemies to the sealed-encounter nav filter. barriers don't affect navigation;
+	the navmesh under them is pre-baked as UNavArea_EncounterBarrier, so neither sealing nor unsealing triggers a navmesh rebuild */
+	UFUNCTION(BlueprintCallable)
+	void SealArena();
+
+	UFUNCTION(BlueprintCallable)
+	void UnsealArena();
+
+	// also applied to enemies added to AssignedEnemyList while the arena is sealed
+	void SetEnemyEncounterSealed(APawn* EnemyInstance, bool bSealed);
+
+protected:
+
+	void SetBarriersActive(bool bActive);
+
+	// true if the barrier carries a nav modifier marking the navmesh under it as UNavArea_EncounterBarrier
+	static bool HasEncounterBarrierNavModifier(const AActor* Barrier);
 };
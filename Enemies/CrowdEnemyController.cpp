@@ -0,0 +1,54 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "CrowdEnemyController.h"
+#include "EnemyNavigationManager.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+
+
+ACrowdEnemyController::ACrowdEnemyController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent")))
+{
+	CrowdFollowingComponent = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
+
+	// starts obstacle-only; the navigation manager enables avoidance within its agent budget
+	bCrowdAvoidanceEnabled = false;
+}
+
+
+void ACrowdEnemyController::OnPossess(APawn* InPawn)
+{
+	// call to parent function
+	Super::OnPossess(InPawn);
+
+	if (InPawn == nullptr) { return; }
+
+	// crowd simulation replaces RVO; running both makes agents fight each other
+	if (ACharacter* Character = Cast<ACharacter>(InPawn))
+	{ Character->GetCharacterMovement()->SetAvoidanceEnabled(false); }
+
+	SetCrowdAvoidanceEnabled(false);
+
+	if (AEnemyNavigationManager* NavigationManager = AEnemyNavigationManager::Get(this))
+	{ NavigationManager->RegisterCrowdController(this); }
+}
+
+
+void ACrowdEnemyController::OnUnPossess()
+{
+	if (AEnemyNavigationManager* NavigationManager = AEnemyNavigationManager::Get(this))
+	{ NavigationManager->UnregisterCrowdController(this); }
+
+	Super::OnUnPossess();
+}
+
+
+void ACrowdEnemyController::SetCrowdAvoidanceEnabled(bool bEnabled)
+{
+	bCrowdAvoidanceEnabled = bEnabled;
+
+	if (CrowdFollowingComponent)
+	{ CrowdFollowingComponent->SetCrowdSimulationState(bEnabled ? ECrowdSimulationState::Enabled : ECrowdSimulationState::ObstacleOnly); }
+}
@@ -0,0 +1,38 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyController.h"
+#include "CrowdEnemyController.generated.h"
+
+/**
+ *  enemy controller variant that steers through the shared detour crowd simulation instead of per-agent RVO.
+ *  the navigation manager decides which crowd controllers get full avoidance (the ones nearest the player); the rest only avoid obstacles
+ */
+UCLASS()
+class ACTIONRPGPROJECT_API ACrowdEnemyController : public AEnemyController
+{
+	GENERATED_BODY()
+
+public:
+
+	ACrowdEnemyController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	// called when the AIController is taken over
+	virtual void OnPossess(APawn* InPawn) override;
+
+	virtual void OnUnPossess() override;
+
+	// switch between full crowd avoidance and obstacle-only steering
+	void SetCrowdAvoidanceEnabled(bool bEnabled);
+
+	FORCEINLINE bool IsCrowdAvoidanceEnabled() const { return bCrowdAvoidanceEnabled; }
+
+private:
+
+	UPROPERTY()
+	class UCrowdFollowingComponent* CrowdFollowingComponent;
+
+	bool bCrowdAvoidanceEnabled;
+};
@@ -24,6 +24,7 @@
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "../World//EnemySpawn.h"
+#include "../Framework/GameplayDatabase.h"
 
 // sets default values
 AEnemy::AEnemy()
@@ -42,6 +43,7 @@ AEnemy::AEnemy()
 	BehaviorType = EEnemyBehaviorType::EMS_Engager;
 
 	PrimaryAssignedZone = 0;
+	CurrentZone = 0;
 
 	// default statuses
 	EnemyMovementStatus = EEnemyMovementStatus::EMS_Idle;
@@ -152,7 +154,10 @@ void AEnemy::PostInitProperties()
 	if (EnemyDefaultsDataTable)
 	{
 		static const FString ContextStringStats = (TEXT("Enemy Stats Data Context"));
-		FEnemyStatDefaults* EnemyStatData = EnemyDefaultsDataTable->FindRow<FEnemyStatDefaults>(FName(TEXT("Defaults")), ContextStringStats, true);
+		// baked database first (no row lookup by name); falls back to the table itself if it wasn't baked
+		FEnemyStatDefaults BakedStatData;
+		FEnemyStatDefaults* EnemyStatData = FGameplayDatabase::Get().FindEnemyStatDefaults(EnemyDefaultsDataTable, FName(TEXT("Defaults")), BakedStatData) ?
+			&BakedStatData : EnemyDefaultsDataTable->FindRow<FEnemyStatDefaults>(FName(TEXT("Defaults")), ContextStringStats, true);
 		if (EnemyStatData)
 		{
 			MaxHealth = EnemyStatData->MaxHealth;
@@ -614,7 +619,10 @@ void AEnemy::Die(AActor* Causer)
 	}
 
 	if (SpawnPoint)
-	{ SpawnPoint->bShouldRespawnOnLoad = false; }
+	{
+		SpawnPoint->bShouldRespawnOnLoad = false;
+		SpawnPoint->LiveEnemy = nullptr;
+	}
 
 	// clear focus + set Blackboard isAlive key to false
 	if (EnemyController)
@@ -635,7 +643,10 @@ void AEnemy::OnExecuted()
 	SetEnemyAwarenessLevel(EEnemyAwarenessLevel::EMS_Passive);
 
 	if (SpawnPoint)
-	{ SpawnPoint->bShouldRespawnOnLoad = false; }
+	{
+		SpawnPoint->bShouldRespawnOnLoad = false;
+		SpawnPoint->LiveEnemy = nullptr;
+	}
 
 	// clear focus + set Blackboard isAlive key to false
 	if (EnemyController)
@@ -135,6 +135,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	TArray<int32> AllowedNeighborZones;
 
+	// zone the enemy currently occupies; starts as PrimaryAssignedZone and follows completed relocations
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
+	int32 CurrentZone;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	bool bCurrentlyRelocating;
 
@@ -8,9 +8,13 @@
 #include "Perception/AISenseConfig_Hearing.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Enemy.h"
+#include "EnemyNavigationManager.h"
+#include "NavFilter_SealedEncounter.h"
+#include "NavigationSystem.h"
 
 
-AEnemyController::AEnemyController()
+AEnemyController::AEnemyController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {	
 	// construct blackboard component
 	BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
@@ -21,6 +25,13 @@ AEnemyController::AEnemyController()
 	BehaviorTreeComponent = CreateDefaultSubobject<UBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
 	// assert valid; halt execution if not
 	check(BlackboardComponent);
+
+	RelocationTargetZone = INDEX_NONE;
+	PendingPathRequestID = 0;
+	PendingRelocationZone = INDEX_NONE;
+
+	SealedEncounterFilterClass = UNavFilter_SealedEncounter::StaticClass();
+	bEncounterSealed = false;
 }
 
 
@@ -46,4 +57,188 @@ void AEnemyController::OnPossess(APawn* InPawn)
 		if (Enemy->GetBehaviorTree())
 		{ BlackboardComponent->InitializeBlackboard(*(Enemy->GetBehaviorTree()->BlackboardAsset)); }
 	}
-}
\ No newline at end of file
+}
+
+
+void AEnemyController::OnUnPossess()
+{
+	CancelBudgetedMove();
+
+	Super::OnUnPossess();
+}
+
+
+void AEnemyController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
+{
+	Super::OnMoveCompleted(RequestID, Result);
+
+	if (RelocationTargetZone == INDEX_NONE || RequestID != RelocationRequestID)
+	{ return; }
+
+	if (AEnemy* Enemy = Cast<AEnemy>(GetPawn()))
+	{
+		if (Result.IsSuccess())
+		{ Enemy->CurrentZone = RelocationTargetZone; }
+
+		Enemy->bCurrentlyRelocating = false;
+	}
+
+	RelocationTargetZone = INDEX_NONE;
+}
+
+
+bool AEnemyController::MoveToZoneLocation(int32 TargetZone, FVector Destination, float AcceptanceRadius)
+{
+	AEnemy* Enemy = Cast<AEnemy>(GetPawn());
+
+	if (!Enemy)
+	{ return false; }
+
+	FAIMoveRequest MoveRequest(Destination);
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+
+	FNavPathSharedPtr CorridorPath;
+
+	// reuse the cached zone corridor if there is one
+	AEnemyNavigationManager* NavigationManager = AEnemyNavigationManager::Get(this);
+	TArray<FVector> PathPoints;
+
+	// corridors are built unfiltered and may cross encounter barriers
+	if (!bEncounterSealed && NavigationManager && NavigationManager->GetRelocationPath(Enemy->CurrentZone, TargetZone, Enemy->GetActorLocation(), Destination, PathPoints))
+	{
+		CorridorPath = MakeShareable(new FNavigationPath(PathPoints, nullptr));
+
+		if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+		{ CorridorPath->SetNavigationDataUsed(NavSys->GetNavDataForProps(GetNavAgentPropertiesRef())); }
+	}
+
+	// no cached corridor for this zone pair; regular (budgeted) path query
+	if (!CorridorPath.IsValid())
+	{
+		if (!RequestBudgetedMoveTo(Destination, nullptr, AcceptanceRadius))
+		{ return false; }
+
+		// if the move was queued, relocation state is set once its path arrives
+		if (IsAwaitingBudgetedPath())
+		{
+			PendingRelocationZone = TargetZone;
+			Enemy->bCurrentlyRelocating = true;
+			return true;
+		}
+
+		RelocationRequestID = GetCurrentMoveRequestID();
+	}
+
+	else
+	{
+		CancelBudgetedMove();
+		RelocationRequestID = RequestMove(MoveRequest, CorridorPath);
+	}
+
+	if (!RelocationRequestID.IsValid())
+	{ return false; }
+
+	RelocationTargetZone = TargetZone;
+	Enemy->bCurrentlyRelocating = true;
+
+	return true;
+}
+
+
+bool AEnemyController::RequestBudgetedMoveTo(FVector Destination, AActor* GoalActor, float AcceptanceRadius)
+{
+	// supersedes any move still waiting on its path
+	CancelBudgetedMove();
+
+	FAIMoveRequest MoveRequest;
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+
+	if (GoalActor)
+	{ MoveRequest.SetGoalActor(GoalActor); }
+
+	else
+	{ MoveRequest.SetGoalLocation(Destination); }
+
+	AEnemyNavigationManager* NavigationManager = AEnemyNavigationManager::Get(this);
+
+	// no broker in this level; path immediately
+	if (!NavigationManager)
+	{ return MoveTo(MoveRequest).Code == EPathFollowingRequestResult::RequestSuccessful; }
+
+	PendingPathRequestID = NavigationManager->SubmitPathRequest(this, Destination, GoalActor,
+		FOnBrokeredPathFound::CreateUObject(this, &AEnemyController::OnBudgetedPathFound));
+
+	if (PendingPathRequestID == 0)
+	{ return false; }
+
+	PendingMoveRequest = MoveRequest;
+	return true;
+}
+
+
+void AEnemyController::CancelBudgetedMove()
+{
+	if (PendingPathRequestID == 0)
+	{ return; }
+
+	if (AEnemyNavigationManager* NavigationManager = AEnemyNavigationManager::Get(this))
+	{ NavigationManager->CancelPathRequests(this); }
+
+	if (PendingRelocationZone != INDEX_NONE)
+	{
+		if (AEnemy* Enemy = Cast<AEnemy>(GetPawn()))
+		{ Enemy->bCurrentlyRelocating = false; }
+	}
+
+	PendingPathRequestID = 0;
+	PendingRelocationZone = INDEX_NONE;
+}
+
+
+void AEnemyController::OnBudgetedPathFound(FNavPathSharedPtr NavPath)
+{
+	// any earlier request was cancelled when this one was submitted, so a result here is always for the pending move
+	const int32 TargetZone = PendingRelocationZone;
+	PendingPathRequestID = 0;
+	PendingRelocationZone = INDEX_NONE;
+
+	AEnemy* Enemy = Cast<AEnemy>(GetPawn());
+	FAIRequestID MoveRequestID;
+
+	if (NavPath.IsValid() && Enemy)
+	{
+		// keep following a moving goal actor, as a regular MoveTo would
+		if (AActor* GoalActor = PendingMoveRequest.GetGoalActor())
+		{ NavPath->SetGoalActorObservation(*GoalActor, 100.f); }
+
+		MoveRequestID = RequestMove(PendingMoveRequest, NavPath);
+	}
+
+	if (TargetZone != INDEX_NONE && Enemy)
+	{
+		RelocationTargetZone = MoveRequestID.IsValid() ? TargetZone : INDEX_NONE;
+		RelocationRequestID = MoveRequestID;
+		Enemy->bCurrentlyRelocating = MoveRequestID.IsValid();
+	}
+
+	if (!MoveRequestID.IsValid())
+	{ OnBudgetedMoveFailed(); }
+}
+
+
+void AEnemyController::SetEncounterSealed(bool bSealed)
+{
+	if (bSealed == bEncounterSealed)
+	{ return; }
+
+	bEncounterSealed = bSealed;
+
+	if (bSealed)
+	{
+		UnsealedFilterClass = DefaultNavigationFilterClass;
+		DefaultNavigationFilterClass = SealedEncounterFilterClass;
+	}
+
+	else
+	{ DefaultNavigationFilterClass = UnsealedFilterClass; }
+}
@@ -17,7 +17,7 @@ class ACTIONRPGPROJECT_API AEnemyController : public AAIController
 
 public:
 
-	AEnemyController();
+	AEnemyController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -25,6 +25,42 @@ public:
 	// called when the AIController is taken over
 	virtual void OnPossess(APawn* Pawn) override;
 
+	virtual void OnUnPossess() override;
+
+	virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
+
+	/* relocate the enemy to a location in another zone. reuses the navigation manager's cached zone corridor when
+	available (only the legs joining it are path-found); falls back to a regular MoveTo otherwise */
+	UFUNCTION(BlueprintCallable, Category = "AI Behavior")
+	bool MoveToZoneLocation(int32 TargetZone, FVector Destination, float AcceptanceRadius = 50.f);
+
+	/* move to Destination (or GoalActor, if set) via the navigation manager's path broker, so queries from many enemies at once are spread
+	across frames. the move starts once the path arrives; returns false if the request couldn't be queued (or started, without a manager) */
+	UFUNCTION(BlueprintCallable, Category = "AI Behavior")
+	bool RequestBudgetedMoveTo(FVector Destination, AActor* GoalActor = nullptr, float AcceptanceRadius = 50.f);
+
+	// cancel any budgeted move still waiting on its path
+	UFUNCTION(BlueprintCallable, Category = "AI Behavior")
+	void CancelBudgetedMove();
+
+	UFUNCTION(BlueprintPure, Category = "AI Behavior")
+	bool IsAwaitingBudgetedPath() const { return PendingPathRequestID != 0; }
+
+	// called when a budgeted move's path query fails
+	UFUNCTION(BlueprintImplementableEvent, Category = "AI Behavior")
+	void OnBudgetedMoveFailed();
+
+	// nav filter used while this enemy's arena is sealed; excludes encounter barrier areas
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI Behavior")
+	TSubclassOf<class UNavigationQueryFilter> SealedEncounterFilterClass;
+
+	// switch pathing between the default filter and SealedEncounterFilterClass (a filter swap; the navmesh is untouched)
+	UFUNCTION(BlueprintCallable, Category = "AI Behavior")
+	void SetEncounterSealed(bool bSealed);
+
+	UFUNCTION(BlueprintPure, Category = "AI Behavior")
+	bool IsEncounterSealed() const { return bEncounterSealed; }
+
 private:
 
 	// blackboard component for this enemy
@@ -34,6 +70,27 @@ private:
 	// behavior tree component for this enemy
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBehaviorTreeComponent* BehaviorTreeComponent;
+
+	// zone the current relocation move is headed to; INDEX_NONE if not relocating
+	int32 RelocationTargetZone;
+
+	FAIRequestID RelocationRequestID;
+
+	// broker request ID of the budgeted move waiting on its path; 0 if none
+	uint32 PendingPathRequestID;
+
+	// move to issue once the pending path arrives
+	FAIMoveRequest PendingMoveRequest;
+
+	// target zone of the pending move, if it's a relocation; INDEX_NONE otherwise
+	int32 PendingRelocationZone;
+
+	void OnBudgetedPathFound(FNavPathSharedPtr NavPath);
+
+	bool bEncounterSealed;
+
+	// filter in use before the arena was sealed, restored on unseal
+	TSubclassOf<UNavigationQueryFilter> UnsealedFilterClass;
 	
 public:
 
@@ -0,0 +1,480 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "../Enemies/EnemyNavigationManager.h"
+#include "../Enemies/CrowdEnemyController.h"
+#include "../Enemies/Enemy.h"
+#include "../World/EnemySpawn.h"
+#include "AIController.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "NavigationPath.h"
+#include "NavigationSystem.h"
+
+// sets default values
+AEnemyNavigationManager::AEnemyNavigationManager()
+{
+	// only ticks while path requests are queued or crowd controllers are registered
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	bBuildZonePathsOnBeginPlay = true;
+	CorridorJoinRadius = 300.f;
+
+	MaxPathRequestsPerFrame = 2;
+	MaxPathRequestsInFlight = 8;
+	AwarenessPriorityWeight = 5000.f;
+	NextPathRequestID = 1;
+
+	MaxCrowdAgents = 20;
+	MaxCrowdStateChangesPerFrame = 4;
+	CrowdEvaluationInterval = 0.5f;
+	TimeSinceCrowdEvaluation = 0.f;
+}
+
+
+// the manager registered for each world; Get() is called per-enemy, so it shouldn't scan the world's actors
+TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AEnemyNavigationManager>> AEnemyNavigationManager::RegisteredManagers;
+
+
+AEnemyNavigationManager* AEnemyNavigationManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World)
+	{ return nullptr; }
+
+	const TWeakObjectPtr<AEnemyNavigationManager>* Manager = RegisteredManagers.Find(World);
+	return Manager ? Manager->Get() : nullptr;
+}
+
+
+// registers before any BeginPlay in the level, so enemies placed alongside the manager can find it
+void AEnemyNavigationManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	if (UWorld* World = GetWorld())
+	{
+		TWeakObjectPtr<AEnemyNavigationManager>& Manager = RegisteredManagers.FindOrAdd(World);
+		if (Manager.IsValid() && Manager.Get() != this)
+		{ UE_LOG(LogTemp, Warning, TEXT("%s: more than one manager placed in %s; only the first is used"), *GetName(), *World->GetName()); }
+
+		else
+		{ Manager = this; }
+	}
+}
+
+
+// called when the game starts or when spawned
+void AEnemyNavigationManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{ NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &AEnemyNavigationManager::OnNavigationGenerationFinished); }
+
+	GatherZoneAnchors();
+
+	if (bBuildZonePathsOnBeginPlay)
+	{ BuildZonePaths(); }
+}
+
+
+void AEnemyNavigationManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{ NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &AEnemyNavigationManager::OnNavigationGenerationFinished); }
+
+	QueuedPathRequests.Empty();
+	InFlightPathRequests.Empty();
+	CrowdControllers.Empty();
+	PendingCrowdStateChanges.Empty();
+
+
+	const TWeakObjectPtr<AEnemyNavigationManager>* Manager = RegisteredManagers.Find(GetWorld());
+	if (Manager && (!Manager->IsValid() || Manager->Get() == this))
+	{ RegisteredManagers.Remove(GetWorld()); }
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AEnemyNavigationManager::GatherZoneAnchors()
+{
+	ZoneAnchors.Empty();
+
+	TMap<int32, int32> SpawnsPerZone;
+
+	for (TActorIterator<AEnemySpawn> It(GetWorld()); It; ++It)
+	{
+		ZoneAnchors.FindOrAdd(It->PrimaryAssignedZone) += It->GetActorLocation();
+		SpawnsPerZone.FindOrAdd(It->PrimaryAssignedZone) += 1;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	for (auto& ZoneAnchor : ZoneAnchors)
+	{
+		// average of the zone's spawn locations, snapped onto the navmesh
+		ZoneAnchor.Value /= float(SpawnsPerZone[ZoneAnchor.Key]);
+
+		FNavLocation ProjectedAnchor;
+		if (NavSys && NavSys->ProjectPointToNavigation(ZoneAnchor.Value, ProjectedAnchor))
+		{ ZoneAnchor.Value = ProjectedAnchor.Location; }
+	}
+}
+
+
+void AEnemyNavigationManager::BuildZonePaths()
+{
+	ZonePaths.Empty();
+
+	for (TActorIterator<AEnemySpawn> It(GetWorld()); It; ++It)
+	{
+		for (const int32 NeighborZone : It->AllowedNeighborZones)
+		{
+			FindOrBuildCorridor(It->PrimaryAssignedZone, NeighborZone);
+			FindOrBuildCorridor(NeighborZone, It->PrimaryAssignedZone);
+		}
+	}
+}
+
+
+void AEnemyNavigationManager::InvalidateZonePaths()
+{
+	for (auto& ZonePath : ZonePaths)
+	{ ZonePath.Value.bValid = false; }
+}
+
+
+void AEnemyNavigationManager::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	InvalidateZonePaths();
+}
+
+
+const FZonePathCorridor* AEnemyNavigationManager::FindOrBuildCorridor(int32 FromZone, int32 ToZone)
+{
+	if (FromZone == ToZone)
+	{ return nullptr; }
+
+	FZonePathCorridor& Corridor = ZonePaths.FindOrAdd(FIntPoint(FromZone, ToZone));
+
+	if (!Corridor.bValid)
+	{
+		const FVector* FromAnchor = ZoneAnchors.Find(FromZone);
+		const FVector* ToAnchor = ZoneAnchors.Find(ToZone);
+
+		Corridor.PathPoints.Reset();
+
+		if (FromAnchor && ToAnchor)
+		{ Corridor.bValid = AppendPathPoints(*FromAnchor, *ToAnchor, false, Corridor.PathPoints); }
+	}
+
+	return Corridor.bValid ? &Corridor : nullptr;
+}
+
+
+bool AEnemyNavigationManager::AppendPathPoints(const FVector& Start, const FVector& End, bool bSkipFirstPoint, TArray<FVector>& OutPathPoints) const
+{
+	UNavigationPath* NavPath = UNavigationSystemV1::FindPathToLocationSynchronously(GetWorld(), Start, End);
+
+	if (!NavPath || !NavPath->IsValid() || NavPath->IsPartial())
+	{ return false; }
+
+	for (int32 i = bSkipFirstPoint ? 1 : 0; i < NavPath->PathPoints.Num(); ++i)
+	{ OutPathPoints.Add(NavPath->PathPoints[i]); }
+
+	return true;
+}
+
+
+bool AEnemyNavigationManager::GetRelocationPath(int32 FromZone, int32 ToZone, const FVector& Start, const FVector& Destination, TArray<FVector>& OutPathPoints)
+{
+	const FZonePathCorridor* Corridor = FindOrBuildCorridor(FromZone, ToZone);
+
+	if (!Corridor || Corridor->PathPoints.Num() < 2)
+	{ return false; }
+
+	const TArray<FVector>& CorridorPoints = Corridor->PathPoints;
+
+	// enter the corridor at whichever point is closest to the enemy (anything before it would be backtracking)
+	int32 EntryIndex = 0;
+	float ClosestEntryDistSq = MAX_FLT;
+
+	for (int32 i = 0; i < CorridorPoints.Num() - 1; ++i)
+	{
+		const float DistSq = FVector::DistSquared(Start, CorridorPoints[i]);
+		if (DistSq < ClosestEntryDistSq)
+		{
+			ClosestEntryDistSq = DistSq;
+			EntryIndex = i;
+		}
+	}
+
+	OutPathPoints.Reset();
+	OutPathPoints.Add(Start);
+
+	// first leg: join the corridor (only path-found if not already standing on it)
+	if (ClosestEntryDistSq > FMath::Square(CorridorJoinRadius))
+	{
+		OutPathPoints.Reset();
+		if (!AppendPathPoints(Start, CorridorPoints[EntryIndex], false, OutPathPoints))
+		{ return false; }
+	}
+
+	else
+	{ OutPathPoints.Add(CorridorPoints[EntryIndex]); }
+
+	// cached corridor
+	for (int32 i = EntryIndex + 1; i < CorridorPoints.Num(); ++i)
+	{ OutPathPoints.Add(CorridorPoints[i]); }
+
+	// last leg: corridor exit (the destination zone's anchor) to the actual destination
+	if (FVector::DistSquared(CorridorPoints.Last(), Destination) > FMath::Square(CorridorJoinRadius))
+	{ return AppendPathPoints(CorridorPoints.Last(), Destination, true, OutPathPoints); }
+
+	OutPathPoints.Add(Destination);
+	return true;
+}
+
+
+uint32 AEnemyNavigationManager::SubmitPathRequest(AAIController* Requester, const FVector& GoalLocation, AActor* GoalActor, FOnBrokeredPathFound OnPathFound)
+{
+	if (!Requester || !Requester->GetPawn())
+	{ return 0; }
+
+	FBrokeredPathRequest& Request = QueuedPathRequests.AddDefaulted_GetRef();
+	Request.RequestID = NextPathRequestID++;
+	Request.Requester = Requester;
+	Request.GoalLocation = GoalLocation;
+	Request.GoalActor = GoalActor;
+	Request.OnPathFound = OnPathFound;
+
+	// wrap around, skipping 0 (reserved for "rejected")
+	if (NextPathRequestID == 0)
+	{ NextPathRequestID = 1; }
+
+	SetActorTickEnabled(true);
+
+	return Request.RequestID;
+}
+
+
+void AEnemyNavigationManager::CancelPathRequests(AAIController* Requester)
+{
+	QueuedPathRequests.RemoveAll([Requester](const FBrokeredPathRequest& Request) { return Request.Requester.Get() == Requester; });
+
+	// in-flight queries can't be recalled from the nav system; just unbind so their results are discarded
+	for (auto& InFlightRequest : InFlightPathRequests)
+	{
+		if (InFlightRequest.Value.Requester.Get() == Requester)
+		{ InFlightRequest.Value.OnPathFound.Unbind(); }
+	}
+}
+
+
+// called every frame (only while path requests are queued or crowd controllers are registered)
+void AEnemyNavigationManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TickPathBroker();
+	TickCrowdBudget(DeltaTime);
+
+	UpdateTickEnabled();
+}
+
+
+void AEnemyNavigationManager::UpdateTickEnabled()
+{
+	SetActorTickEnabled(QueuedPathRequests.Num() > 0 || CrowdControllers.Num() > 0);
+}
+
+
+void AEnemyNavigationManager::TickPathBroker()
+{
+	// requesters may have been destroyed (or lost their pawns) since submitting
+	QueuedPathRequests.RemoveAll([](const FBrokeredPathRequest& Request) { return !Request.Requester.IsValid() || !Request.Requester->GetPawn(); });
+
+	if (QueuedPathRequests.Num() == 0)
+	{ return; }
+
+	int32 DispatchBudget = FMath::Min(MaxPathRequestsPerFrame, MaxPathRequestsInFlight - InFlightPathRequests.Num());
+
+	if (DispatchBudget <= 0)
+	{ return; }
+
+	// re-prioritize every frame; enemies (and the player) move while waiting
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	QueuedPathRequests.Sort([this, &PlayerLocation](const FBrokeredPathRequest& A, const FBrokeredPathRequest& B)
+	{ return GetPathRequestPriority(A, PlayerLocation) < GetPathRequestPriority(B, PlayerLocation); });
+
+	int32 NumProcessed = 0;
+	TArray<FOnBrokeredPathFound> FailedRequests;
+
+	for (; NumProcessed < QueuedPathRequests.Num() && DispatchBudget > 0; ++NumProcessed)
+	{
+		FBrokeredPathRequest& Request = QueuedPathRequests[NumProcessed];
+
+		if (DispatchPathRequest(Request))
+		{ --DispatchBudget; }
+
+		// couldn't even be queried (no nav data, etc); fail immediately rather than retrying every frame
+		else
+		{ FailedRequests.Add(Request.OnPathFound); }
+	}
+
+	QueuedPathRequests.RemoveAt(0, NumProcessed, false);
+
+	// executed after the queue is updated, since callbacks may submit new requests
+	for (const FOnBrokeredPathFound& OnPathFound : FailedRequests)
+	{ OnPathFound.ExecuteIfBound(nullptr); }
+}
+
+
+float AEnemyNavigationManager::GetPathRequestPriority(const FBrokeredPathRequest& Request, const FVector& PlayerLocation) const
+{
+	const APawn* Pawn = Request.Requester.IsValid() ? Request.Requester->GetPawn() : nullptr;
+
+	if (!Pawn)
+	{ return MAX_FLT; }
+
+	float Priority = FVector::Dist(Pawn->GetActorLocation(), PlayerLocation);
+
+	// each awareness level above passive moves the request ahead by AwarenessPriorityWeight
+	if (const AEnemy* Enemy = Cast<AEnemy>(Pawn))
+	{ Priority -= float(Enemy->EnemyAwarenessLevel) * AwarenessPriorityWeight; }
+
+	return Priority;
+}
+
+
+bool AEnemyNavigationManager::DispatchPathRequest(FBrokeredPathRequest& Request)
+{
+	AAIController* Requester = Request.Requester.Get();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!Requester || !Requester->GetPawn() || !NavSys)
+	{ return false; }
+
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(Requester->GetNavAgentPropertiesRef());
+
+	if (!NavData)
+	{ return false; }
+
+	const FVector GoalLocation = Request.GoalActor.IsValid() ? Request.GoalActor->GetActorLocation() : Request.GoalLocation;
+
+	FPathFindingQuery Query(Requester, *NavData, Requester->GetNavAgentLocation(), GoalLocation,
+		UNavigationQueryFilter::GetQueryFilter(*NavData, Requester, Requester->GetDefaultNavigationFilterClass()));
+
+	const uint32 QueryID = NavSys->FindPathAsync(Requester->GetNavAgentPropertiesRef(), Query,
+		FNavPathQueryDelegate::CreateUObject(this, &AEnemyNavigationManager::OnAsyncPathFound), EPathFindingMode::Regular);
+
+	if (QueryID == INVALID_NAVQUERYID)
+	{ return false; }
+
+	InFlightPathRequests.Add(QueryID, MoveTemp(Request));
+	return true;
+}
+
+
+void AEnemyNavigationManager::OnAsyncPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr NavPath)
+{
+	FBrokeredPathRequest Request;
+
+	if (!InFlightPathRequests.RemoveAndCopyValue(QueryID, Request))
+	{ return; }
+
+	if (!Request.Requester.IsValid())
+	{ return; }
+
+	const bool bSucceeded = Result == ENavigationQueryResult::Success && NavPath.IsValid() && NavPath->IsValid();
+	Request.OnPathFound.ExecuteIfBound(bSucceeded ? NavPath : nullptr);
+
+	// results free up in-flight slots; resume dispatching anything still queued
+	UpdateTickEnabled();
+}
+
+
+void AEnemyNavigationManager::RegisterCrowdController(ACrowdEnemyController* CrowdController)
+{
+	if (!CrowdController)
+	{ return; }
+
+	CrowdControllers.AddUnique(CrowdController);
+
+	// rank the newcomer on the next tick rather than waiting out the interval
+	TimeSinceCrowdEvaluation = CrowdEvaluationInterval;
+	UpdateTickEnabled();
+}
+
+
+void AEnemyNavigationManager::UnregisterCrowdController(ACrowdEnemyController* CrowdController)
+{
+	CrowdControllers.Remove(CrowdController);
+
+	// frees up an avoidance slot for someone else
+	if (CrowdController && CrowdController->IsCrowdAvoidanceEnabled())
+	{ TimeSinceCrowdEvaluation = CrowdEvaluationInterval; }
+
+	UpdateTickEnabled();
+}
+
+
+void AEnemyNavigationManager::TickCrowdBudget(float DeltaTime)
+{
+	if (CrowdControllers.Num() == 0)
+	{ return; }
+
+	TimeSinceCrowdEvaluation += DeltaTime;
+
+	if (TimeSinceCrowdEvaluation >= CrowdEvaluationInterval)
+	{
+		TimeSinceCrowdEvaluation = 0.f;
+		EvaluateCrowdBudget();
+	}
+
+	// switch avoidance states under the per-frame budget; disables were queued first, so slots free up before being reassigned
+	int32 NumApplied = 0;
+
+	for (; NumApplied < PendingCrowdStateChanges.Num() && NumApplied < MaxCrowdStateChangesPerFrame; ++NumApplied)
+	{
+		const TPair<TWeakObjectPtr<ACrowdEnemyController>, bool>& StateChange = PendingCrowdStateChanges[NumApplied];
+
+		if (StateChange.Key.IsValid())
+		{ StateChange.Key->SetCrowdAvoidanceEnabled(StateChange.Value); }
+	}
+
+	PendingCrowdStateChanges.RemoveAt(0, NumApplied, false);
+}
+
+
+void AEnemyNavigationManager::EvaluateCrowdBudget()
+{
+	CrowdControllers.RemoveAll([](const TWeakObjectPtr<ACrowdEnemyController>& CrowdController) { return !CrowdController.IsValid() || !CrowdController->GetPawn(); });
+
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	// nearest the player first
+	CrowdControllers.Sort([&PlayerLocation](const TWeakObjectPtr<ACrowdEnemyController>& A, const TWeakObjectPtr<ACrowdEnemyController>& B)
+	{ return FVector::DistSquared(A->GetPawn()->GetActorLocation(), PlayerLocation) < FVector::DistSquared(B->GetPawn()->GetActorLocation(), PlayerLocation); });
+
+	PendingCrowdStateChanges.Reset();
+
+	// only queue controllers whose state actually needs to change
+	for (int32 i = MaxCrowdAgents; i < CrowdControllers.Num(); ++i)
+	{
+		if (CrowdControllers[i]->IsCrowdAvoidanceEnabled())
+		{ PendingCrowdStateChanges.Emplace(CrowdControllers[i], false); }
+	}
+
+	for (int32 i = 0; i < FMath::Min(MaxCrowdAgents, CrowdControllers.Num()); ++i)
+	{
+		if (!CrowdControllers[i]->IsCrowdAvoidanceEnabled())
+		{ PendingCrowdStateChanges.Emplace(CrowdControllers[i], true); }
+	}
+}
@@ -0,0 +1,197 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NavigationData.h"
+#include "EnemyNavigationManager.generated.h"
+
+class AAIController;
+class ACrowdEnemyController;
+
+// delivers a brokered path query's result; the path is null if the query failed or was cancelled
+DECLARE_DELEGATE_OneParam(FOnBrokeredPathFound, FNavPathSharedPtr);
+
+// a path query waiting on the broker's per-frame budget
+struct FBrokeredPathRequest
+{
+	uint32 RequestID;
+
+	TWeakObjectPtr<AAIController> Requester;
+
+	// sampled at dispatch time, so the goal actor's current location is used
+	FVector GoalLocation;
+	TWeakObjectPtr<AActor> GoalActor;
+
+	FOnBrokeredPathFound OnPathFound;
+};
+
+// a representative navmesh path between two zones, shared by every enemy relocating along that zone pair
+USTRUCT()
+struct FZonePathCorridor
+{
+	GENERATED_BODY()
+
+	FZonePathCorridor()
+	{
+		bValid = false;
+	}
+
+	UPROPERTY()
+	TArray<FVector> PathPoints;
+
+	// cleared when the navmesh is rebuilt; corridor is re-queried on next request
+	UPROPERTY()
+	bool bValid;
+};
+
+
+/**
+ *  per-level navigation services for enemies; place one in each level containing enemy spawns
+ */
+UCLASS()
+class ACTIONRPGPROJECT_API AEnemyNavigationManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	// sets default values for this actor's properties
+	AEnemyNavigationManager();
+
+	// returns the navigation manager placed in the given object's world, if there is one
+	static AEnemyNavigationManager* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  zone path cache
+	 */
+
+	// if true, corridors for every spawn-assigned zone/neighbor pair are built on BeginPlay; otherwise each is built on first request
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zone Paths")
+	bool bBuildZonePathsOnBeginPlay;
+
+	// corridor entry/exit points within this distance of the enemy (or its destination) are joined directly, without a path query
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zone Paths")
+	float CorridorJoinRadius;
+
+	// build (or rebuild) corridors for every zone pair referenced by the level's enemy spawns
+	UFUNCTION(BlueprintCallable, Category = "Zone Paths")
+	void BuildZonePaths();
+
+	// drop all cached corridors; they'll be re-queried on demand
+	UFUNCTION(BlueprintCallable, Category = "Zone Paths")
+	void InvalidateZonePaths();
+
+	/* builds a relocation path from Start (in FromZone) to Destination (in ToZone) by reusing the cached zone corridor.
+	only the short legs joining the corridor are path-found. returns false if no corridor exists for the pair */
+	bool GetRelocationPath(int32 FromZone, int32 ToZone, const FVector& Start, const FVector& Destination, TArray<FVector>& OutPathPoints);
+
+	/**
+	 *  path request broker
+	 */
+
+	// max number of queued path requests handed to the navigation system's async query queue per frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Broker")
+	int32 MaxPathRequestsPerFrame;
+
+	// max number of dispatched requests awaiting a result at once; further requests stay queued
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Broker")
+	int32 MaxPathRequestsInFlight;
+
+	// priority weight per awareness level step, in units of distance (i.e., a hostile enemy this far away is served before an alert one at the player's feet)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Broker")
+	float AwarenessPriorityWeight;
+
+	/* queue an async path query for the requester's pawn. requests are dispatched under the per-frame budget, highest awareness
+	(then nearest to the player) first; OnPathFound is executed on the game thread. returns the broker request ID (0 if rejected) */
+	uint32 SubmitPathRequest(AAIController* Requester, const FVector& GoalLocation, AActor* GoalActor, FOnBrokeredPathFound OnPathFound);
+
+	// drop any queued or in-flight requests from this requester; their callbacks won't be executed
+	void CancelPathRequests(AAIController* Requester);
+
+	/**
+	 *  crowd avoidance budget
+	 */
+
+	/* max number of crowd controllers given full crowd avoidance at once (nearest the player first); the rest only avoid obstacles.
+	keep at or below the crowd manager's MaxAgents (project settings) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	int32 MaxCrowdAgents;
+
+	// max number of crowd controllers whose avoidance state is switched per frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	int32 MaxCrowdStateChangesPerFrame;
+
+	// how often (in seconds) crowd controllers are re-ranked by distance to the player
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd")
+	float CrowdEvaluationInterval;
+
+	void RegisterCrowdController(ACrowdEnemyController* CrowdController);
+
+	void UnregisterCrowdController(ACrowdEnemyController* CrowdController);
+
+	// called every frame (only while path requests are queued or crowd controllers are registered)
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+
+	// called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void PostInitializeComponents() override;
+
+	// per-world registration backing Get()
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AEnemyNavigationManager>> RegisteredManagers;
+
+	// navmesh-projected representative location for each zone, averaged from the enemy spawns assigned to it
+	UPROPERTY(VisibleInstanceOnly, Category = "Zone Paths")
+	TMap<int32, FVector> ZoneAnchors;
+
+	// cached corridors, keyed by (FromZone, ToZone)
+	TMap<FIntPoint, FZonePathCorridor> ZonePaths;
+
+	void GatherZoneAnchors();
+
+	const FZonePathCorridor* FindOrBuildCorridor(int32 FromZone, int32 ToZone);
+
+	// runs a synchronous path query; appends the resulting points (minus the start point if bSkipFirstPoint) to OutPathPoints
+	bool AppendPathPoints(const FVector& Start, const FVector& End, bool bSkipFirstPoint, TArray<FVector>& OutPathPoints) const;
+
+	// any navmesh rebuild (barriers toggled, etc) can invalidate corridors
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	// requests waiting on the per-frame budget
+	TArray<FBrokeredPathRequest> QueuedPathRequests;
+
+	// dispatched requests, keyed by the navigation system's async query ID
+	TMap<uint32, FBrokeredPathRequest> InFlightPathRequests;
+
+	uint32 NextPathRequestID;
+
+	// lower is served first
+	float GetPathRequestPriority(const FBrokeredPathRequest& Request, const FVector& PlayerLocation) const;
+
+	bool DispatchPathRequest(FBrokeredPathRequest& Request);
+
+	void OnAsyncPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr NavPath);
+
+	void TickPathBroker();
+
+	TArray<TWeakObjectPtr<ACrowdEnemyController>> CrowdControllers;
+
+	// controllers waiting for their avoidance state to be switched, nearest the player first
+	TArray<TPair<TWeakObjectPtr<ACrowdEnemyController>, bool>> PendingCrowdStateChanges;
+
+	float TimeSinceCrowdEvaluation;
+
+	void TickCrowdBudget(float DeltaTime);
+
+	void EvaluateCrowdBudget();
+
+	// keep ticking only while there's something to process
+	void UpdateTickEnabled();
+};
@@ -0,0 +1,13 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "NavArea_EncounterBarrier.h"
+
+
+UNavArea_EncounterBarrier::UNavArea_EncounterBarrier(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// same cost as the default area while the arena is open
+	DefaultCost = 1.f;
+	DrawColor = FColor::Orange;
+}
@@ -0,0 +1,21 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavAreas/NavArea.h"
+#include "NavArea_EncounterBarrier.generated.h"
+
+/**
+ *  nav area baked under encounter barriers (via a NavModifier component on the barrier). passable by default;
+ *  enemies in a sealed arena switch to UNavFilter_SealedEncounter, which excludes it, so sealing never touches the navmesh itself
+ */
+UCLASS()
+class ACTIONRPGPROJECT_API UNavArea_EncounterBarrier : public UNavArea
+{
+	GENERATED_BODY()
+
+public:
+
+	UNavArea_EncounterBarrier(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
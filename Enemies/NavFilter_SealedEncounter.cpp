@@ -0,0 +1,16 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "NavFilter_SealedEncounter.h"
+#include "NavArea_EncounterBarrier.h"
+
+
+UNavFilter_SealedEncounter::UNavFilter_SealedEncounter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	FNavigationFilterArea BarrierArea;
+	BarrierArea.AreaClass = UNavArea_EncounterBarrier::StaticClass();
+	BarrierArea.bIsExcluded = true;
+
+	Areas.Add(BarrierArea);
+}
@@ -0,0 +1,20 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "NavFilter_SealedEncounter.generated.h"
+
+/**
+ *  query filter for enemies in a sealed arena; treats encounter barrier areas as impassable
+ */
+UCLASS()
+class ACTIONRPGPROJECT_API UNavFilter_SealedEncounter : public UNavigationQueryFilter
+{
+	GENERATED_BODY()
+
+public:
+
+	UNavFilter_SealedEncounter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
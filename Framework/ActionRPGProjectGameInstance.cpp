@@ -2,6 +2,7 @@
 
 
 #include "ActionRPGProject/Framework/ActionRPGProjectGameInstance.h"
+#include "ActionRPGProject/Framework/GameplayDatabase.h"
 #include <MoviePlayer/Public/MoviePlayer.h>
 
 UActionRPGProjectGameInstance::UActionRPGProjectGameInstance()
@@ -19,6 +20,14 @@ void UActionRPGProjectGameInstance::Init()
 	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UActionRPGProjectGameInstance::EndLoadingScreen);
 }
 
+
+void UActionRPGProjectGameInstance::Shutdown()
+{
+	FGameplayDatabase::Get().Unload();
+
+	Super::Shutdown();
+}
+
 void UActionRPGProjectGameInstance::BeginLoadingScreen(const FString& InMapName)
 {
 	if (!IsRunningDedicatedServer())
@@ -23,6 +23,8 @@ public:
 
 	virtual void Init() override;
 
+	virtual void Shutdown() override;
+
 	UFUNCTION()
 	virtual void BeginLoadingScreen(const FString& MapName);
 	UFUNCTION()
@@ -0,0 +1,481 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "ActionRPGProject/Framework/GameplayDatabase.h"
+#include "../Enemies/Enemy.h"
+#include "../Items/Item.h"
+#include "../World/ItemSpawn.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/DataTable.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "GameDelegates.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectIterator.h"
+#endif
+
+
+FGameplayDatabase& FGameplayDatabase::Get()
+{
+	// mapped on first use rather than by the game instance, so class defaults (built before it exists) read the same data as their instances
+	static FGameplayDatabase Database;
+	return Database;
+}
+
+
+FGameplayDatabase::FGameplayDatabase()
+	: MappedFile(nullptr)
+	, MappedRegion(nullptr)
+	, Data(nullptr)
+	, Header(nullptr)
+{
+	// the editor (and PIE) reads the source data, which a baked file may be behind
+	if (!GIsEditor)
+	{ Load(); }
+}
+
+
+FGameplayDatabase::~FGameplayDatabase()
+{
+	Unload();
+}
+
+
+FString FGameplayDatabase::GetDatabaseFilename()
+{
+	return FPaths::ProjectContentDir() / TEXT("Baked") / TEXT("GameplayDatabase.bin");
+}
+
+
+uint64 FGameplayDatabase::MakePathKey(const FString& PathName)
+{
+	const FTCHARToUTF8 PathUTF8(*PathName.ToLower());
+	return CityHash64(PathUTF8.Get(), PathUTF8.Length());
+}
+
+
+uint64 FGameplayDatabase::MakeRowKey(uint64 TableKey, FName RowName)
+{
+	const FTCHARToUTF8 RowUTF8(*RowName.ToString().ToLower());
+	return CityHash64WithSeed(RowUTF8.Get(), RowUTF8.Length(), TableKey);
+}
+
+
+bool FGameplayDatabase::Load()
+{
+	Unload();
+
+	const FString Filename = GetDatabaseFilename();
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	MappedFile = PlatformFile.OpenMapped(*Filename);
+
+	if (MappedFile)
+	{
+		MappedRegion = MappedFile->MapRegion(0, MappedFile->GetFileSize());
+
+		if (MappedRegion)
+		{ Data = MappedRegion->GetMappedPtr(); }
+	}
+
+	// platform can't map files; fall back to a single read into memory
+	if (!Data)
+	{
+		if (!FFileHelper::LoadFileToArray(LoadedFileData, *Filename, FILEREAD_Silent))
+		{
+			Unload();
+			return false;
+		}
+
+		Data = LoadedFileData.GetData();
+	}
+
+	const int64 FileSize = MappedRegion ? MappedRegion->GetMappedSize() : LoadedFileData.Num();
+	const FGameplayDatabaseHeader* FileHeader = reinterpret_cast<const FGameplayDatabaseHeader*>(Data);
+
+	if (FileSize < int64(sizeof(FGameplayDatabaseHeader)) || FileHeader->Magic != GAMEPLAY_DATABASE_MAGIC || FileHeader->Version != GAMEPLAY_DATABASE_VERSION)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GameplayDatabase: %s is missing or out of date; using data tables"), *Filename);
+		Unload();
+		return false;
+	}
+
+	if (!IsValidFile(*FileHeader, FileSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("GameplayDatabase: %s is truncated or corrupt; using data tables"), *Filename);
+		Unload();
+		return false;
+	}
+
+	Header = FileHeader;
+	return true;
+}
+
+
+void FGameplayDatabase::Unload()
+{
+	Header = nullptr;
+	Data = nullptr;
+
+	delete MappedRegion;
+	MappedRegion = nullptr;
+
+	delete MappedFile;
+	MappedFile = nullptr;
+
+	LoadedFileData.Empty();
+	PathKeyCache.Empty();
+	ResolvedItemClasses.Empty();
+}
+
+
+// a section of NumRecords records at Offset lies within the file (and is aligned for reading in place)
+template <typename RecordType>
+static bool IsSectionInFile(const uint64 Offset, const uint64 NumRecords, const int64 FileSize)
+{
+	return Offset % alignof(RecordType) == 0 && Offset <= uint64(FileSize) && NumRecords <= (uint64(FileSize) - Offset) / sizeof(RecordType);
+}
+
+
+bool FGameplayDatabase::IsValidFile(const FGameplayDatabaseHeader& FileHeader, const int64 FileSize) const
+{
+	if (!IsSectionInFile<FBakedEnemyStats>(FileHeader.EnemyStatsOffset, FileHeader.NumEnemyStats, FileSize)
+		|| !IsSectionInFile<FBakedLootTable>(FileHeader.LootTablesOffset, FileHeader.NumLootTables, FileSize)
+		|| !IsSectionInFile<FBakedLootRow>(FileHeader.LootRowsOffset, FileHeader.NumLootRows, FileSize)
+		|| !IsSectionInFile<FBakedLootItem>(FileHeader.LootItemsOffset, FileHeader.NumLootItems, FileSize)
+		|| !IsSectionInFile<FBakedItemStats>(FileHeader.ItemStatsOffset, FileHeader.NumItemStats, FileSize)
+		|| !IsSectionInFile<ANSICHAR>(FileHeader.StringTableOffset, FileHeader.StringTableSize, FileSize))
+	{ return false; }
+
+	// loot tables -> rows -> items -> strings; checked once here, so lookups can index straight in
+	const FBakedLootTable* LootTables = GetSection<FBakedLootTable>(FileHeader.LootTablesOffset);
+
+	for (uint32 i = 0; i < FileHeader.NumLootTables; ++i)
+	{
+		if (uint64(LootTables[i].FirstRow) + LootTables[i].NumRows > FileHeader.NumLootRows)
+		{ return false; }
+	}
+
+	const FBakedLootRow* LootRows = GetSection<FBakedLootRow>(FileHeader.LootRowsOffset);
+
+	for (uint32 i = 0; i < FileHeader.NumLootRows; ++i)
+	{
+		if (uint64(LootRows[i].FirstItem) + LootRows[i].NumItems > FileHeader.NumLootItems)
+		{ return false; }
+	}
+
+	const FBakedLootItem* LootItems = GetSection<FBakedLootItem>(FileHeader.LootItemsOffset);
+
+	for (uint32 i = 0; i < FileHeader.NumLootItems; ++i)
+	{
+		if (uint64(LootItems[i].ClassPathOffset) + LootItems[i].ClassPathLength > FileHeader.StringTableSize)
+		{ return false; }
+	}
+
+	return true;
+}
+
+
+uint64 FGameplayDatabase::GetPathKey(const UObject* Object) const
+{
+	if (const uint64* CachedKey = PathKeyCache.Find(Object))
+	{ return *CachedKey; }
+
+	return PathKeyCache.Add(Object, MakePathKey(Object->GetPathName()));
+}
+
+
+template <typename RecordType>
+const RecordType* FGameplayDatabase::FindByKey(const RecordType* Records, uint32 NumRecords, uint64 Key)
+{
+	const int32 Index = Algo::LowerBoundBy(TArrayView<const RecordType>(Records, NumRecords), Key, [](const RecordType& Record) { return Record.Key; });
+
+	return (Index < int32(NumRecords) && Records[Index].Key == Key) ? &Records[Index] : nullptr;
+}
+
+
+const FBakedEnemyStats* FGameplayDatabase::FindEnemyStats(const UDataTable* Table, FName RowName) const
+{
+	if (!Header || !Table)
+	{ return nullptr; }
+
+	return FindByKey(GetSection<FBakedEnemyStats>(Header->EnemyStatsOffset), Header->NumEnemyStats, MakeRowKey(GetPathKey(Table), RowName));
+}
+
+
+bool FGameplayDatabase::FindEnemyStatDefaults(const UDataTable* Table, FName RowName, FEnemyStatDefaults& OutStats) const
+{
+	const FBakedEnemyStats* BakedStats = FindEnemyStats(Table, RowName);
+
+	if (!BakedStats)
+	{ return false; }
+
+	OutStats.MaxHealth = BakedStats->MaxHealth;
+	OutStats.Damage = BakedStats->Damage;
+	OutStats.MaxPoise = BakedStats->MaxPoise;
+	OutStats.PoiseRecoveryDelay = BakedStats->PoiseRecoveryDelay;
+	OutStats.MaxStunValue = BakedStats->MaxStunValue;
+	OutStats.StunValueDrainRate = BakedStats->StunValueDrainRate;
+	OutStats.StunRecoveryDelay = BakedStats->StunRecoveryDelay;
+	OutStats.StaggerRecoveryDelay = BakedStats->StaggerRecoveryDelay;
+	OutStats.PerceptionRange = BakedStats->PerceptionRange;
+	OutStats.VisionRange = BakedStats->VisionRange;
+	OutStats.VisionAggroRange = BakedStats->VisionAggroRange;
+	OutStats.HearingAggroRange = BakedStats->HearingAggroRange;
+	OutStats.TargetLossDelay = BakedStats->TargetLossDelay;
+
+	return true;
+}
+
+
+const FBakedLootTable* FGameplayDatabase::FindLootTable(const UDataTable* Table) const
+{
+	if (!Header || !Table)
+	{ return nullptr; }
+
+	return FindByKey(GetSection<FBakedLootTable>(Header->LootTablesOffset), Header->NumLootTables, GetPathKey(Table));
+}
+
+
+const FBakedLootRow& FGameplayDatabase::GetLootRow(const FBakedLootTable& LootTable, uint32 RowIndex) const
+{
+	check(RowIndex < LootTable.NumRows);
+	return GetSection<FBakedLootRow>(Header->LootRowsOffset)[LootTable.FirstRow + RowIndex];
+}
+
+
+const FBakedLootItem& FGameplayDatabase::GetLootItem(const FBakedLootRow& LootRow, uint32 ItemIndex) const
+{
+	check(ItemIndex < LootRow.NumItems);
+	return GetSection<FBakedLootItem>(Header->LootItemsOffset)[LootRow.FirstItem + ItemIndex];
+}
+
+
+TSubclassOf<UItem> FGameplayDatabase::ResolveLootItemClass(const FBakedLootItem& LootItem) const
+{
+	if (const TWeakObjectPtr<UClass>* ResolvedClass = ResolvedItemClasses.Find(LootItem.ClassPathOffset))
+	{
+		if (ResolvedClass->IsValid())
+		{ return ResolvedClass->Get(); }
+	}
+
+	const ANSICHAR* ClassPath = reinterpret_cast<const ANSICHAR*>(Data + Header->StringTableOffset + LootItem.ClassPathOffset);
+	const FUTF8ToTCHAR ClassPathConverted(ClassPath, LootItem.ClassPathLength);
+	const FString ClassPathName(ClassPathConverted.Length(), ClassPathConverted.Get());
+
+	UClass* ItemClass = FSoftClassPath(ClassPathName).ResolveClass();
+
+	if (!ItemClass)
+	{ ItemClass = FSoftClassPath(ClassPathName).TryLoadClass<UItem>(); }
+
+	ResolvedItemClasses.Add(LootItem.ClassPathOffset, ItemClass);
+	return ItemClass;
+}
+
+
+const FBakedItemStats* FGameplayDatabase::FindItemStats(const UClass* ItemClass) const
+{
+	if (!Header || !ItemClass)
+	{ return nullptr; }
+
+	return FindByKey(GetSection<FBakedItemStats>(Header->ItemStatsOffset), Header->NumItemStats, GetPathKey(ItemClass));
+}
+
+
+#if WITH_EDITOR
+void FGameplayDatabase::Bake()
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FAssetData> DataTableAssets;
+	AssetRegistry.GetAssetsByClass(UDataTable::StaticClass()->GetFName(), DataTableAssets);
+
+	TArray<FBakedEnemyStats> EnemyStats;
+	TArray<TPair<uint64, TArray<const FLootTableRow*>>> LootTables;
+	TArray<FBakedLootRow> LootRows;
+	TArray<FBakedLootItem> LootItems;
+	TArray<ANSICHAR> StringTable;
+
+	TMap<FString, uint32> StringOffsets;
+
+	for (const FAssetData& DataTableAsset : DataTableAssets)
+	{
+		const UDataTable* Table = Cast<UDataTable>(DataTableAsset.GetAsset());
+
+		if (!Table || !Table->GetRowStruct())
+		{ continue; }
+
+		const uint64 TableKey = MakePathKey(Table->GetPathName());
+
+		if (Table->GetRowStruct()->IsChildOf(FEnemyStatDefaults::StaticStruct()))
+		{
+			for (const auto& Row : Table->GetRowMap())
+			{
+				const FEnemyStatDefaults* Stats = reinterpret_cast<const FEnemyStatDefaults*>(Row.Value);
+
+				FBakedEnemyStats& BakedStats = EnemyStats.AddZeroed_GetRef();
+				BakedStats.Key = MakeRowKey(TableKey, Row.Key);
+				BakedStats.MaxHealth = Stats->MaxHealth;
+				BakedStats.Damage = Stats->Damage;
+				BakedStats.MaxPoise = Stats->MaxPoise;
+				BakedStats.PoiseRecoveryDelay = Stats->PoiseRecoveryDelay;
+				BakedStats.MaxStunValue = Stats->MaxStunValue;
+				BakedStats.StunValueDrainRate = Stats->StunValueDrainRate;
+				BakedStats.StunRecoveryDelay = Stats->StunRecoveryDelay;
+				BakedStats.StaggerRecoveryDelay = Stats->StaggerRecoveryDelay;
+				BakedStats.PerceptionRange = Stats->PerceptionRange;
+				BakedStats.VisionRange = Stats->VisionRange;
+				BakedStats.VisionAggroRange = Stats->VisionAggroRange;
+				BakedStats.HearingAggroRange = Stats->HearingAggroRange;
+				BakedStats.TargetLossDelay = Stats->TargetLossDelay;
+			}
+		}
+
+		else if (Table->GetRowStruct()->IsChildOf(FLootTableRow::StaticStruct()))
+		{
+			TArray<const FLootTableRow*>& Rows = LootTables.Emplace_GetRef(TableKey, TArray<const FLootTableRow*>()).Value;
+
+			for (const auto& Row : Table->GetRowMap())
+			{ Rows.Add(reinterpret_cast<const FLootTableRow*>(Row.Value)); }
+		}
+	}
+
+	// item Blueprints aren't necessarily loaded yet; load them, so the class iterator sees them
+	TArray<FAssetData> ItemBlueprintAssets;
+	UItem::GetItemBlueprintAssets(ItemBlueprintAssets);
+
+	for (const FAssetData& ItemBlueprintAsset : ItemBlueprintAssets)
+	{ ItemBlueprintAsset.GetAsset(); }
+
+	TArray<FBakedItemStats> ItemStats;
+
+	for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+	{
+		const UClass* ItemClass = *ClassIt;
+
+		// skeleton and reinstanced Blueprint classes are editor-only copies
+		if (!ItemClass->IsChildOf(UItem::StaticClass()) || ItemClass->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists)
+			|| ItemClass->GetName().StartsWith(TEXT("SKEL_")) || ItemClass->GetName().StartsWith(TEXT("REINST_")))
+		{ continue; }
+
+		const UItem* ItemDefaults = ItemClass->GetDefaultObject<UItem>();
+
+		FBakedItemStats& BakedItemStats = ItemStats.AddZeroed_GetRef();
+		BakedItemStats.Key = MakePathKey(ItemClass->GetPathName());
+		BakedItemStats.Weight = ItemDefaults->GetWeight();
+		BakedItemStats.MaxStackSize = ItemDefaults->GetMaxStackSize();
+		BakedItemStats.DefaultQuantity = ItemDefaults->GetQuantity();
+		BakedItemStats.Rarity = uint8(ItemDefaults->GetRarity());
+		BakedItemStats.bStackable = ItemDefaults->IsStackable();
+	}
+
+	EnemyStats.Sort([](const FBakedEnemyStats& A, const FBakedEnemyStats& B) { return A.Key < B.Key; });
+	ItemStats.Sort([](const FBakedItemStats& A, const FBakedItemStats& B) { return A.Key < B.Key; });
+	LootTables.Sort([](const TPair<uint64, TArray<const FLootTableRow*>>& A, const TPair<uint64, TArray<const FLootTableRow*>>& B) { return A.Key < B.Key; });
+
+	// flatten loot tables -> rows -> items, in key order
+	TArray<FBakedLootTable> BakedLootTables;
+
+	for (const auto& LootTable : LootTables)
+	{
+		FBakedLootTable& BakedLootTable = BakedLootTables.AddZeroed_GetRef();
+		BakedLootTable.Key = LootTable.Key;
+		BakedLootTable.FirstRow = LootRows.Num();
+		BakedLootTable.NumRows = LootTable.Value.Num();
+
+		for (const FLootTableRow* Row : LootTable.Value)
+		{
+			FBakedLootRow& BakedRow = LootRows.AddZeroed_GetRef();
+			BakedRow.Probability = Row->Probability;
+			BakedRow.FirstItem = LootItems.Num();
+
+			for (const auto& ItemClass : Row->Items)
+			{
+				if (!ItemClass)
+				{ continue; }
+
+				const FString ClassPathName = ItemClass->GetPathName();
+				const FTCHARToUTF8 ClassPathUTF8(*ClassPathName);
+
+				// identical paths share one string
+				uint32* ExistingOffset = StringOffsets.Find(ClassPathName);
+				const uint32 ClassPathOffset = ExistingOffset ? *ExistingOffset : StringTable.Num();
+
+				if (!ExistingOffset)
+				{
+					StringOffsets.Add(ClassPathName, ClassPathOffset);
+					StringTable.Append(ClassPathUTF8.Get(), ClassPathUTF8.Length());
+				}
+
+				FBakedLootItem& BakedItem = LootItems.AddZeroed_GetRef();
+				BakedItem.ClassPathOffset = ClassPathOffset;
+				BakedItem.ClassPathLength = ClassPathUTF8.Length();
+				BakedItem.DefaultQuantity = ItemClass->GetDefaultObject<UItem>()->GetQuantity();
+
+				++BakedRow.NumItems;
+			}
+		}
+	}
+
+	// header, then each section in order (records are 4- or 8-byte aligned and sized accordingly; item stats are padded up to 8 bytes)
+	FGameplayDatabaseHeader BakedHeader;
+	FMemory::Memzero(BakedHeader);
+	BakedHeader.Magic = GAMEPLAY_DATABASE_MAGIC;
+	BakedHeader.Version = GAMEPLAY_DATABASE_VERSION;
+	BakedHeader.NumEnemyStats = EnemyStats.Num();
+	BakedHeader.NumLootTables = BakedLootTables.Num();
+	BakedHeader.NumLootRows = LootRows.Num();
+	BakedHeader.NumLootItems = LootItems.Num();
+	BakedHeader.NumItemStats = ItemStats.Num();
+	BakedHeader.StringTableSize = StringTable.Num();
+
+	BakedHeader.EnemyStatsOffset = sizeof(FGameplayDatabaseHeader);
+	BakedHeader.LootTablesOffset = BakedHeader.EnemyStatsOffset + EnemyStats.Num() * sizeof(FBakedEnemyStats);
+	BakedHeader.LootRowsOffset = BakedHeader.LootTablesOffset + BakedLootTables.Num() * sizeof(FBakedLootTable);
+	BakedHeader.LootItemsOffset = BakedHeader.LootRowsOffset + LootRows.Num() * sizeof(FBakedLootRow);
+	BakedHeader.ItemStatsOffset = Align(BakedHeader.LootItemsOffset + LootItems.Num() * sizeof(FBakedLootItem), alignof(FBakedItemStats));
+	BakedHeader.StringTableOffset = BakedHeader.ItemStatsOffset + ItemStats.Num() * sizeof(FBakedItemStats);
+
+	TArray<uint8> FileData;
+	FileData.Reserve(BakedHeader.StringTableOffset + StringTable.Num());
+	FileData.Append(reinterpret_cast<const uint8*>(&BakedHeader), sizeof(BakedHeader));
+	FileData.Append(reinterpret_cast<const uint8*>(EnemyStats.GetData()), EnemyStats.Num() * sizeof(FBakedEnemyStats));
+	FileData.Append(reinterpret_cast<const uint8*>(BakedLootTables.GetData()), BakedLootTables.Num() * sizeof(FBakedLootTable));
+	FileData.Append(reinterpret_cast<const uint8*>(LootRows.GetData()), LootRows.Num() * sizeof(FBakedLootRow));
+	FileData.Append(reinterpret_cast<const uint8*>(LootItems.GetData()), LootItems.Num() * sizeof(FBakedLootItem));
+	FileData.SetNumZeroed(BakedHeader.ItemStatsOffset);
+	FileData.Append(reinterpret_cast<const uint8*>(ItemStats.GetData()), ItemStats.Num() * sizeof(FBakedItemStats));
+	FileData.Append(reinterpret_cast<const uint8*>(StringTable.GetData()), StringTable.Num());
+
+	const FString Filename = GetDatabaseFilename();
+
+	if (FFileHelper::SaveArrayToFile(FileData, *Filename))
+	{ UE_LOG(LogTemp, Log, TEXT("GameplayDatabase: baked %d enemy stat rows, %d loot tables, %d item classes to %s"), EnemyStats.Num(), BakedLootTables.Num(), ItemStats.Num(), *Filename); }
+
+	else
+	{ UE_LOG(LogTemp, Error, TEXT("GameplayDatabase: couldn't write %s"), *Filename); }
+}
+
+static FAutoConsoleCommand GameplayDatabaseBakeCommand(
+	TEXT("GameplayDatabase.Bake"),
+	TEXT("Bake all enemy stat and loot data tables, and item class stats, into the gameplay database file"),
+	FConsoleCommandDelegate::CreateStatic(&FGameplayDatabase::Bake));
+
+// bake at the start of every cook, so a build never ships data older than its tables and item definitions
+static struct FGameplayDatabaseCookHook
+{
+	FGameplayDatabaseCookHook()
+	{
+		FGameDelegates::Get().GetCookModificationDelegate().BindLambda([](TArray<FString>& ExtraPackagesToCook)
+		{
+			FGameplayDatabase::Bake();
+		});
+	}
+} GameplayDatabaseCookHook;
+#endif
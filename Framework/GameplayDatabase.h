@@ -0,0 +1,191 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/ObjectKey.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UClass;
+class UDataTable;
+class UItem;
+struct FEnemyStatDefaults;
+
+/**
+ *  baked file layout. every section is a flat array of the records below, sorted by key where keyed, so lookups are a binary search
+ *  straight over the mapped file. bump GAMEPLAY_DATABASE_VERSION whenever a record changes; mismatched files are ignored (and the
+ *  game falls back to the source data tables)
+ */
+
+#define GAMEPLAY_DATABASE_MAGIC 0x42445047 // 'GPDB'
+#define GAMEPLAY_DATABASE_VERSION 2
+
+struct FGameplayDatabaseHeader
+{
+	uint32 Magic;
+	uint32 Version;
+
+	uint32 NumEnemyStats;
+	uint32 NumLootTables;
+	uint32 NumLootRows;
+	uint32 NumLootItems;
+	uint32 NumItemStats;
+	uint32 StringTableSize;
+
+	// byte offsets from the start of the file
+	uint64 EnemyStatsOffset;
+	uint64 LootTablesOffset;
+	uint64 LootRowsOffset;
+	uint64 LootItemsOffset;
+	uint64 ItemStatsOffset;
+	uint64 StringTableOffset;
+};
+
+// one FEnemyStatDefaults row
+struct FBakedEnemyStats
+{
+	// see FGameplayDatabase::MakeRowKey
+	uint64 Key;
+
+	float MaxHealth;
+	float Damage;
+	float MaxPoise;
+	float PoiseRecoveryDelay;
+	float MaxStunValue;
+	float StunValueDrainRate;
+	float StunRecoveryDelay;
+	float StaggerRecoveryDelay;
+	float PerceptionRange;
+	float VisionRange;
+	float VisionAggroRange;
+	float HearingAggroRange;
+	float TargetLossDelay;
+	uint32 Padding;
+};
+
+// one FLootTableRow table; its rows are contiguous in the loot row section
+struct FBakedLootTable
+{
+	// see FGameplayDatabase::MakePathKey
+	uint64 Key;
+
+	uint32 FirstRow;
+	uint32 NumRows;
+};
+
+// one FLootTableRow; its items are contiguous in the loot item section
+struct FBakedLootRow
+{
+	float Probability;
+
+	uint32 FirstItem;
+	uint32 NumItems;
+};
+
+struct FBakedLootItem
+{
+	// item class path name, in the string table (not null-terminated)
+	uint32 ClassPathOffset;
+	uint32 ClassPathLength;
+
+	// the item class's default quantity, so rolling loot doesn't need the class default object
+	int32 DefaultQuantity;
+};
+
+// one item class's static data, from its definition and class defaults
+struct FBakedItemStats
+{
+	// see FGameplayDatabase::MakePathKey (of the item class)
+	uint64 Key;
+
+	float Weight;
+	int32 MaxStackSize;
+	int32 DefaultQuantity;
+	uint8 Rarity;
+	uint8 bStackable;
+	uint16 Padding;
+};
+
+
+/**
+ *  read-only view of the baked gameplay database (enemy stat defaults, loot tables, item stats). the file is memory-mapped on first use and
+ *  read in place; nothing is parsed or copied. it's baked at the start of every cook (or by hand, with the editor console command
+ *  "GameplayDatabase.Bake"); stage the output (Content/Baked) with the build. the editor never loads it, so edits to the source tables
+ *  and item definitions apply without a re-bake
+ */
+class ACTIONRPGPROJECT_API FGameplayDatabase
+{
+public:
+
+	static FGameplayDatabase& Get();
+
+	~FGameplayDatabase();
+
+	// map the baked file; returns false (leaving the database empty) if it's missing, from another version, or truncated/corrupt
+	bool Load();
+
+	void Unload();
+
+	bool IsLoaded() const { return Header != nullptr; }
+
+	// baked equivalent of Table->FindRow<FEnemyStatDefaults>(RowName); null if not baked
+	const FBakedEnemyStats* FindEnemyStats(const UDataTable* Table, FName RowName) const;
+
+	// convenience; copies a baked row into the data table row struct. returns false if not baked
+	bool FindEnemyStatDefaults(const UDataTable* Table, FName RowName, FEnemyStatDefaults& OutStats) const;
+
+	// baked equivalent of Table->GetAllRows<FLootTableRow>(); null if not baked
+	const FBakedLootTable* FindLootTable(const UDataTable* Table) const;
+
+	const FBakedLootRow& GetLootRow(const FBakedLootTable& LootTable, uint32 RowIndex) const;
+
+	const FBakedLootItem& GetLootItem(const FBakedLootRow& LootRow, uint32 ItemIndex) const;
+
+	// resolves (and caches) the item's class; items referenced by a loaded loot table are already in memory
+	TSubclassOf<UItem> ResolveLootItemClass(const FBakedLootItem& LootItem) const;
+
+	// baked weight, stacking, rarity, and default quantity of an item class; null if not baked
+	const FBakedItemStats* FindItemStats(const UClass* ItemClass) const;
+
+	static FString GetDatabaseFilename();
+
+	// stable 64-bit keys; tables (and item classes) are identified by their path name
+	static uint64 MakePathKey(const FString& PathName);
+	static uint64 MakeRowKey(uint64 TableKey, FName RowName);
+
+#if WITH_EDITOR
+	// gather every FEnemyStatDefaults and FLootTableRow data table, and every item class, in the project and write the baked file
+	static void Bake();
+#endif
+
+private:
+
+	FGameplayDatabase();
+
+	IMappedFileHandle* MappedFile;
+	IMappedFileRegion* MappedRegion;
+
+	// used instead of a mapping on platforms that can't map files
+	TArray<uint8> LoadedFileData;
+
+	const uint8* Data;
+	const FGameplayDatabaseHeader* Header;
+
+	// path key per table/item class, so lookups don't rebuild path names
+	mutable TMap<FObjectKey, uint64> PathKeyCache;
+
+	mutable TMap<uint32, TWeakObjectPtr<UClass>> ResolvedItemClasses;
+
+	uint64 GetPathKey(const UObject* Object) const;
+
+	// every section, and every index from one record into another section, lies within the file
+	bool IsValidFile(const FGameplayDatabaseHeader& FileHeader, const int64 FileSize) const;
+
+	template <typename RecordType>
+	const RecordType* GetSection(uint64 Offset) const { return reinterpret_cast<const RecordType*>(Data + Offset); }
+
+	template <typename RecordType>
+	static const RecordType* FindByKey(const RecordType* Records, uint32 NumRecords, uint64 Key);
+};
@@ -11,9 +11,7 @@
 
 UEquippableItem::UEquippableItem()
 {
-	bStackable = false;
 	bEquipped = false;
-	UseActionText = LOCTEXT("ItemUseActionText", "Equip");
 }
 
 
@@ -24,10 +22,10 @@ void UEquippableItem::Use(class AMain* Character)
 		for (int32 i = 0; i < Slots.Num(); ++i)
 		{
 			// if item is already equipped, unequip. if not, equip
-			if (Character->GetEquippedItems().Contains(Slots[i]) && !bEquipped)
+			if (!bEquipped)
 			{
-				UEquippableItem* AlreadyEquippedItem = *Character->GetEquippedItems().Find(Slots[i]);
-				AlreadyEquippedItem->SetEquipped(false);
+				if (UEquippableItem* AlreadyEquippedItem = Character->FindEquippedItem(Slots[i]))
+				{ AlreadyEquippedItem->SetEquipped(false); }
 			}
 		}
 
@@ -60,6 +58,12 @@ bool UEquippableItem::ShouldShowInInventory() const
 }
 
 
+FText UEquippableItem::GetUseActionText() const
+{
+	return bEquipped ? LOCTEXT("UnequipText", "Unequip") : LOCTEXT("EquipText", "Equip");
+}
+
+
 void UEquippableItem::AddedToInventory(class UInventoryComponent* Inventory, int32 QuantityAdded = 1)
 {
 	Super::AddedToInventory(Inventory, QuantityAdded);
@@ -75,7 +79,7 @@ void UEquippableItem::AddedToInventory(class UInventoryComponent* Inventory, int
 			{
 				for (int32 i = 0; i < Slots.Num(); ++i)
 				{
-					if (!Character->GetEquippedItems().Contains(Slots[i]))
+					if (!Character->FindEquippedItem(Slots[i]))
 					{ SetEquipped(true); }
 				}
 			}
@@ -95,8 +99,6 @@ void UEquippableItem::EquipStatusChanged()
 {
 	if (AMain* Character = Cast<AMain>(GetOuter()))
 	{
-		UseActionText = bEquipped ? LOCTEXT("UnequipText", "Unequip") : LOCTEXT("EquipText", "Equip");
-
 		if (bEquipped)
 		{ Equip(Character); }
 		
@@ -53,10 +53,16 @@ public:
 	virtual bool Unequip(class AMain* Character);
 
 	virtual bool ShouldShowInInventory() const override;
+
+	// "equip" or "unequip", depending on equip status
+	virtual FText GetUseActionText() const override;
+
+	// equippable items never stack, whatever their definition says
+	virtual bool IsStackable() const override { return false; }
 	virtual void AddedToInventory(class UInventoryComponent* Inventory, int32 QuantityAdded) override;
 
 	UFUNCTION(BlueprintPure, Category = "Equippables")
-	bool IsEquipped() { return bEquipped; };
+	bool IsEquipped() const { return bEquipped; };
 
 	void SetEquipped(bool bNewEquipped);
 
@@ -28,6 +28,39 @@ bool UGearItem::Equip(class AMain* Character)
 }
 
 
+void UGearItem::GetPresentationAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	Super::GetPresentationAssets(OutAssets);
+
+	GetEquipAssets(OutAssets);
+}
+
+
+void UGearItem::GetEquipAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const TSoftObjectPtr<USkeletalMesh>& GearMesh : Meshes)
+	{
+		if (!GearMesh.IsNull())
+		{ OutAssets.AddUnique(GearMesh.ToSoftObjectPath()); }
+	}
+
+	if (!EquipSound.IsNull())
+	{ OutAssets.AddUnique(EquipSound.ToSoftObjectPath()); }
+}
+
+
+bool UGearItem::AreEquipAssetsLoaded() const
+{
+	for (const TSoftObjectPtr<USkeletalMesh>& GearMesh : Meshes)
+	{
+		if (!GearMesh.IsNull() && !GearMesh.Get())
+		{ return false; }
+	}
+
+	return EquipSound.IsNull() || EquipSound.Get();
+}
+
+
 bool UGearItem::Unequip(class AMain* Character)
 {
 	bool bUnequipSuccessful = Super::Unequip(Character);
@@ -37,10 +37,16 @@ public:
 	virtual bool Equip(class AMain* Character) override;
 	virtual bool Unequip(class AMain* Character) override;
 
+	// adds the gear meshes and equip sound
+	virtual void GetPresentationAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
+	// just what putting the gear on needs (meshes and equip sound); the rest of the presentation assets aren't needed to wear it
+	void GetEquipAssets(TArray<FSoftObjectPath>& OutAssets) const;
+	bool AreEquipAssetsLoaded() const;
+
 	// the skeletal mesh corresponding to this gear
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Gear")
-	//class USkeletalMesh* Mesh;
-	TArray<class USkeletalMesh*> Meshes;
+	TArray<TSoftObjectPtr<class USkeletalMesh>> Meshes;
 
 	// optional material instance to apply to the gear
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Gear")
@@ -56,7 +62,7 @@ public:
 
 	// on-equip sound
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sound")
-	USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sound")
 	float EquipSoundVolumeMultiplier;
@@ -6,10 +6,23 @@
 #include "../Character/MainPlayerController.h"
 #include "../Components/InventoryComponent.h"
 #include "../Framework/ActionRPGProjectGameInstance.h"
+#include "Engine/AssetManager.h"
 #include "Kismet/GameplayStatics.h"
 
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Blueprint.h"
+#include "HAL/IConsoleManager.h"
+#endif
+
 #define LOCTEXT_NAMESPACE "Item"
 
+// the class defaults of a (non-abstract) item Blueprint: where an item type's definition is set
+static bool IsItemBlueprintDefaults(const UItem* Item)
+{
+	return Item->HasAnyFlags(RF_ClassDefaultObject) && !Item->GetClass()->HasAnyClassFlags(CLASS_Native | CLASS_Abstract);
+}
+
 #if WITH_EDITOR
 void UItem::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -19,34 +32,188 @@ void UItem::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChanged
 
 	// UPROPERTY clamping doesn't support using a variable to clamp, so doing it here instead (if Quantity is what changed)
 	if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(UItem, Quantity))
-	{ Quantity = FMath::Clamp(Quantity, 1, bStackable ? MaxStackSize : 1); }
+	{ Quantity = FMath::Clamp(Quantity, 1, GetMaxStackSize()); }
+
+	// cleared; go back to the class's (or the default) definition
+	else if (ChangedPropertyName == GET_MEMBER_NAME_CHECKED(UItem, Definition))
+	{ ResolveDefinition(); }
+}
+
+void UItem::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// only when cooking; logged errors fail the cook, rather than shipping an item type that runs on the default item data
+	if (TargetPlatform && IsItemBlueprintDefaults(this) && !HasOwnDefinition())
+	{ UE_LOG(LogTemp, Error, TEXT("%s has no item definition; assign one (or run Item.MigrateDefinitions) before cooking."), *GetClass()->GetName()); }
 }
 #endif
 
 UItem::UItem()
 {
 	// set default values
-	ItemDisplayName = LOCTEXT("ItemName", "Item");
-	UseActionText = LOCTEXT("ItemUseActionText", "Use");
-	Weight = 0.0f;
-	bStackable = true;
+	Definition = nullptr;
 	Quantity = 1;
-	MaxStackSize = 2;
 	bShouldNotifyOnInventoryAdd = true;
 	bShouldPlayPickupSound = true;
 	bShouldAutoEquip = false;
+	OwningStackId = INDEX_NONE;
+
+#if WITH_EDITORONLY_DATA
+	// the old defaults: Blueprints only saved values that differed from these
+	PickupMesh_DEPRECATED = nullptr;
+	PickupSound_DEPRECATED = nullptr;
+	Thumbnail_DEPRECATED = nullptr;
+	ItemDisplayName_DEPRECATED = LOCTEXT("ItemName", "Item");
+	UseActionText_DEPRECATED = LOCTEXT("ItemUseActionText", "Use");
+	Rarity_DEPRECATED = EItemRarity::IR_Common;
+	Weight_DEPRECATED = 0.0f;
+	bStackable_DEPRECATED = true;
+	MaxStackSize_DEPRECATED = 2;
+#endif
+}
+
+
+void UItem::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// loaded objects don't have their saved values yet
+	if (!HasAnyFlags(RF_NeedLoad))
+	{ ResolveDefinition(); }
+}
+
+
+void UItem::PostLoad()
+{
+	Super::PostLoad();
+
+	ResolveDefinition();
+
+	if (IsItemBlueprintDefaults(this) && !HasOwnDefinition())
+	{
+#if WITH_EDITORONLY_DATA
+		// not yet migrated; keep the Blueprint's own values working (the stand-in is transient, so it's never saved with the Blueprint)
+		Definition = CreateDefinitionFromDeprecatedData(GetTransientPackage(), NAME_None, RF_Transient);
+
+		UE_LOG(LogTemp, Warning, TEXT("%s has no item definition; using its deprecated item properties. Run Item.MigrateDefinitions to generate one."), *GetClass()->GetName());
+#else
+		// PreSave fails the cook for these, so this is a build that skipped it
+		UE_LOG(LogTemp, Error, TEXT("%s has no item definition; using the default item data (stackable, max stack of 2, weightless)."), *GetClass()->GetName());
+#endif
+	}
+}
+
+
+void UItem::ResolveDefinition()
+{
+	if (Definition)
+	{ return; }
+
+	// instances normally copy it from their class defaults when created; this covers anything that didn't
+	const UItem* ClassDefaults = GetClass()->GetDefaultObject<UItem>();
+
+	if (ClassDefaults != this && ClassDefaults->Definition)
+	{ Definition = ClassDefaults->Definition; }
+
+	else // native class defaults, and from them, every item type that doesn't set its own
+	{ Definition = GetMutableDefault<UItemDefinition>(); }
 }
 
 
+bool UItem::HasOwnDefinition() const
+{
+	return Definition && !Definition->HasAnyFlags(RF_ClassDefaultObject | RF_Transient);
+}
+
+
+#if WITH_EDITORONLY_DATA
+UItemDefinition* UItem::CreateDefinitionFromDeprecatedData(UObject* Outer, const FName Name, const EObjectFlags Flags) const
+{
+	UItemDefinition* NewDefinition = NewObject<UItemDefinition>(Outer, Name, Flags);
+
+	NewDefinition->PickupMesh = PickupMesh_DEPRECATED;
+	NewDefinition->PickupSound = PickupSound_DEPRECATED;
+	NewDefinition->Thumbnail = Thumbnail_DEPRECATED;
+	NewDefinition->ItemDisplayName = ItemDisplayName_DEPRECATED;
+	NewDefinition->ItemDescription = ItemDescription_DEPRECATED;
+	NewDefinition->UseActionText = UseActionText_DEPRECATED;
+	NewDefinition->Rarity = Rarity_DEPRECATED;
+	NewDefinition->Weight = Weight_DEPRECATED;
+	NewDefinition->bStackable = bStackable_DEPRECATED;
+	NewDefinition->MaxStackSize = MaxStackSize_DEPRECATED;
+	NewDefinition->ItemTooltip = ItemTooltip_DEPRECATED;
+
+	return NewDefinition;
+}
+#endif
+
+
 void UItem::SetQuantity(const int32 NewQuantity)
 {
 	if (NewQuantity != Quantity)
 	{
-		Quantity = FMath::Clamp(NewQuantity, 0, bStackable? MaxStackSize : 1);
+		Quantity = FMath::Clamp(NewQuantity, 0, GetMaxStackSize());
+
+		// keep the owning inventory's stack (and carried weight) current
+		if (OwningInventory)
+		{ OwningInventory->OnItemQuantityChanged(this); }
+
 		OnItemModified.Broadcast();
 	}
 }
 
+FText UItem::GetUseActionText() const
+{
+	return GetDefinition()->UseActionText;
+}
+
+bool UItem::IsStackable() const
+{
+	return GetDefinition()->bStackable;
+}
+
+void UItem::GetPresentationAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	const UItemDefinition* ItemDefinition = GetDefinition();
+
+	for (const FSoftObjectPath& AssetPath : { ItemDefinition->PickupMesh.ToSoftObjectPath(), ItemDefinition->PickupSound.ToSoftObjectPath(), ItemDefinition->Thumbnail.ToSoftObjectPath() })
+	{
+		if (!AssetPath.IsNull())
+		{ OutAssets.AddUnique(AssetPath); }
+	}
+}
+
+bool UItem::ArePresentationAssetsLoaded() const
+{
+	TArray<FSoftObjectPath> Assets;
+	GetPresentationAssets(Assets);
+
+	for (const FSoftObjectPath& AssetPath : Assets)
+	{
+		if (!AssetPath.ResolveObject())
+		{ return false; }
+	}
+
+	return true;
+}
+
+TSharedPtr<FStreamableHandle> UItem::LoadPresentationAssets(const TArray<const UItem*>& Items, FStreamableDelegate OnLoaded /*= FStreamableDelegate()*/)
+{
+	TArray<FSoftObjectPath> Assets;
+
+	for (const UItem* Item : Items)
+	{
+		if (Item)
+		{ Item->GetPresentationAssets(Assets); }
+	}
+
+	if (Assets.Num() == 0)
+	{ return nullptr; }
+
+	return UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, OnLoaded);
+}
+
 bool UItem::ShouldShowInInventory() const
 {
 	// by default, true
@@ -72,21 +239,99 @@ void UItem::AddedToInventory(class UInventoryComponent* Inventory, int32 Quantit
 					FText AddedToInventoryText;
 
 					if (QuantityAdded > 1)
-					{ AddedToInventoryText = FText::Format(LOCTEXT("AddedToInventoryText", "{Quantity}x {ItemDisplayName}"), QuantityAdded, ItemDisplayName); }
+					{ AddedToInventoryText = FText::Format(LOCTEXT("AddedToInventoryText", "{Quantity}x {ItemDisplayName}"), QuantityAdded, GetDisplayName()); }
 
 					else
-					{ AddedToInventoryText = FText::Format(LOCTEXT("AddedToInventoryText", "{ItemDisplayName}"), ItemDisplayName); }
+					{ AddedToInventoryText = FText::Format(LOCTEXT("AddedToInventoryText", "{ItemDisplayName}"), GetDisplayName()); }
 					
 					PlayerController->ClientShowNotification(AddedToInventoryText);
 				}
 
 				// play pickup sound
-				if (PickupSound && bShouldPlayPickupSound)
-				{ UGameplayStatics::PlaySound2D(GetWorld(), PickupSound); }
+				const TSoftObjectPtr<USoundBase>& PickupSound = GetDefinition()->PickupSound;
+
+				if (!PickupSound.IsNull() && bShouldPlayPickupSound)
+				{
+					if (USoundBase* LoadedPickupSound = PickupSound.Get())
+					{ UGameplayStatics::PlaySound2D(GetWorld(), LoadedPickupSound); }
+
+					else // wasn't prefetched; play it once it's streamed in
+					{
+						UAssetManager::GetStreamableManager().RequestAsyncLoad(PickupSound.ToSoftObjectPath(), FStreamableDelegate::CreateWeakLambda(Character, [Character, PickupSound]()
+						{
+							if (USoundBase* LoadedPickupSound = PickupSound.Get())
+							{ UGameplayStatics::PlaySound2D(Character, LoadedPickupSound); }
+						}));
+					}
+				}
 			}
 		}
 	}
 }
 
 
+#if WITH_EDITOR
+void UItem::GetItemBlueprintAssets(TArray<FAssetData>& OutAssets)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FAssetData> BlueprintAssets;
+	AssetRegistry.GetAssetsByClass(UBlueprint::StaticClass()->GetFName(), BlueprintAssets, true);
+
+	for (const FAssetData& BlueprintAsset : BlueprintAssets)
+	{
+		// skip non-item Blueprints without loading them
+		FString NativeParentClassPath;
+		BlueprintAsset.GetTagValue(FBlueprintTags::NativeParentClassPath, NativeParentClassPath);
+
+		const UClass* NativeParentClass = FindObject<UClass>(nullptr, *FPackageName::ExportTextPathToObjectPath(NativeParentClassPath));
+
+		if (NativeParentClass && NativeParentClass->IsChildOf(UItem::StaticClass()))
+		{ OutAssets.Add(BlueprintAsset); }
+	}
+}
+
+
+void UItem::MigrateDefinitions()
+{
+	TArray<FAssetData> BlueprintAssets;
+	GetItemBlueprintAssets(BlueprintAssets);
+
+	int32 NumMigrated = 0;
+
+	for (const FAssetData& BlueprintAsset : BlueprintAssets)
+	{
+		const UBlueprint* Blueprint = Cast<UBlueprint>(BlueprintAsset.GetAsset());
+		UItem* ItemDefaults = (Blueprint && Blueprint->GeneratedClass) ? Cast<UItem>(Blueprint->GeneratedClass->GetDefaultObject()) : nullptr;
+
+		// already has a real (saved) definition, rather than the default item data or PostLoad's stand-in
+		if (!ItemDefaults || ItemDefaults->HasOwnDefinition())
+		{ continue; }
+
+		// saved next to the Blueprint, i.e. /Game/Items/BP_Sword -> /Game/Items/BP_Sword_Definition
+		const FString DefinitionPackageName = BlueprintAsset.PackageName.ToString() + TEXT("_Definition");
+		UPackage* DefinitionPackage = CreatePackage(*DefinitionPackageName);
+
+		UItemDefinition* NewDefinition = ItemDefaults->CreateDefinitionFromDeprecatedData(DefinitionPackage, FName(*FPackageName::GetShortName(DefinitionPackageName)), RF_Public | RF_Standalone);
+
+		FAssetRegistryModule::AssetCreated(NewDefinition);
+		DefinitionPackage->MarkPackageDirty();
+
+		ItemDefaults->Modify();
+		ItemDefaults->Definition = NewDefinition;
+		ItemDefaults->MarkPackageDirty();
+
+		++NumMigrated;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Item: generated %d item definitions; save the modified packages to keep them"), NumMigrated);
+}
+
+static FAutoConsoleCommand ItemMigrateDefinitionsCommand(
+	TEXT("Item.MigrateDefinitions"),
+	TEXT("Generate a definition asset for every item Blueprint that doesn't have one yet, from its deprecated item properties"),
+	FConsoleCommandDelegate::CreateStatic(&UItem::MigrateDefinitions));
+#endif
+
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "../Items/ItemDefinition.h"
+#include "Engine/StreamableManager.h"
 #include "Item.generated.h"
 
 class UAudioComponent;
@@ -11,15 +13,6 @@ class USoundCue;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnItemModified);
 
-UENUM(BlueprintType)
-enum class EItemRarity : uint8
-{
-	IR_Common UMETA(DisplayName = "Common"),
-	IR_Uncommon UMETA(DisplayName = "Uncommon"),
-	IR_Rare UMETA(DisplayName = "Rare"),
-	IR_Legendary UMETA(DisplayName = "Legendary")
-};
-
 /**
  * 
  */
@@ -34,13 +27,79 @@ protected:
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
+	// items created at runtime (and native class defaults) resolve their definition here; loaded ones in PostLoad
+	virtual void PostInitProperties() override;
+
+	// item Blueprints saved before UItemDefinition existed get a stand-in definition built from their deprecated properties
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	// cook-time validation: item Blueprints can't be cooked without a definition of their own
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+#if WITH_EDITORONLY_DATA
+	/* static data from before UItemDefinition. loaded from old saves (UHT registers these under their original names) but never saved;
+	"Item.MigrateDefinitions" moves it into a definition asset next to each item Blueprint */
+	UPROPERTY()
+	class UStaticMesh* PickupMesh_DEPRECATED;
+
+	UPROPERTY()
+	USoundBase* PickupSound_DEPRECATED;
+
+	UPROPERTY()
+	class UTexture2D* Thumbnail_DEPRECATED;
+
+	UPROPERTY()
+	FText ItemDisplayName_DEPRECATED;
+
+	UPROPERTY()
+	FText ItemDescription_DEPRECATED;
+
+	UPROPERTY()
+	FText UseActionText_DEPRECATED;
+
+	UPROPERTY()
+	EItemRarity Rarity_DEPRECATED;
+
+	UPROPERTY()
+	float Weight_DEPRECATED;
+
+	UPROPERTY()
+	bool bStackable_DEPRECATED;
+
+	UPROPERTY()
+	int32 MaxStackSize_DEPRECATED;
+
+	UPROPERTY()
+	TSubclassOf<class UItemTooltip> ItemTooltip_DEPRECATED;
+
+	// a new definition holding the deprecated static data
+	UItemDefinition* CreateDefinitionFromDeprecatedData(UObject* Outer, const FName Name, const EObjectFlags Flags) const;
+#endif
+
+	// fills in Definition if it's unset: from the class defaults, else the default item data (stand-ins are reported once, per class)
+	void ResolveDefinition();
+
 public:
 	
 	UItem();
 
-	// mesh to display for this item's in-world pickup
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	class UStaticMesh* PickupMesh;
+	/* this item type's static data (display text, meshes, weight, stacking), shared by all of its instances. set on the item class's defaults;
+	classes that don't set one get the default item data */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	UItemDefinition* Definition;
+
+	// false if Definition is the default item data, or a stand-in built from deprecated properties
+	bool HasOwnDefinition() const;
+
+#if WITH_EDITOR
+	// generate a definition asset for every item Blueprint that doesn't have one yet, from its deprecated properties
+	static void MigrateDefinitions();
+
+	// every item Blueprint in the project, found by asset registry tag (nothing is loaded to find them)
+	static void GetItemBlueprintAssets(TArray<struct FAssetData>& OutAssets);
+#endif
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item")
 	bool bShouldNotifyOnInventoryAdd;
@@ -54,57 +113,20 @@ public:
 	UFUNCTION(Category = "Item")
 	FORCEINLINE bool ShouldAutoEquip() const { return bShouldAutoEquip; }
 
-	// on-pickup sound
-	UPROPERTY(EditDefaultsOnly, Category = "Item")
-	USoundBase* PickupSound;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item")
 	bool bShouldPlayPickupSound;
 
-	// thumbnail inventory picture for this item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	class UTexture2D* Thumbnail;
-
-	// inventory display name for this item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText ItemDisplayName;
-
-	// an optional description of the item to display in the inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (MultiLine = true))
-	FText ItemDescription;
-
-	// the verb text for using the item (e.g., equip, eat, etc)
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	FText UseActionText;
-
-	// rarity of the item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	EItemRarity Rarity;
-
-	// weight of the item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 0.0))
-	float Weight;
-
-	// whether or not this item can be stacked in the inventory
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	bool bStackable;
-
-	// maximum size a stack of these items can be
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 2, EditCondition = bStackable))
-	int32 MaxStackSize;
-
-	// inventory tooltip for this item
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
-	TSubclassOf<class UItemTooltip> ItemTooltip;
-
 	// amount of the item
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item", meta = (UIMin = 1, EditCondition = bStackable))
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item", meta = (UIMin = 1))
 	int32 Quantity;
 
 	// the inventory that owns this item
 	UPROPERTY()
 	class UInventoryComponent* OwningInventory;
 
+	// the stack this item was materialized for, within OwningInventory
+	int32 OwningStackId;
+
 	UPROPERTY(BlueprintAssignable)
 	FOnItemModified OnItemModified;
 
@@ -117,8 +139,60 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Item")
 	FORCEINLINE int32 GetQuantity() const { return Quantity; }
 	
+	// this item's definition; resolved when the item is created or loaded (see ResolveDefinition), so never null
+	FORCEINLINE const UItemDefinition* GetDefinition() const { return Definition; }
+
+	// presentation assets are soft references: these return null until the asset has been loaded (see LoadPresentationAssets)
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE class UStaticMesh* GetPickupMesh() const { return GetDefinition()->PickupMesh.Get(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE class USoundBase* GetPickupSound() const { return GetDefinition()->PickupSound.Get(); }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE class UTexture2D* GetThumbnail() const { return GetDefinition()->Thumbnail.Get(); }
+
+	// for widgets that load the thumbnail themselves (i.e., UImage::SetBrushFromSoftTexture)
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE TSoftObjectPtr<class UTexture2D> GetThumbnailAsset() const { return GetDefinition()->Thumbnail; }
+
+	// every soft-referenced asset needed to show/use this item (pickup mesh, thumbnail, sounds, and subclass assets like gear meshes)
+	virtual void GetPresentationAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
+	bool ArePresentationAssetsLoaded() const;
+
+	/* async-load the presentation assets of the given items (class default objects are fine). the assets stay loaded while the returned
+	handle is held. OnLoaded is called once they're in; null is returned (and OnLoaded not called) if there's nothing to load */
+	static TSharedPtr<FStreamableHandle> LoadPresentationAssets(const TArray<const UItem*>& Items, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE FText GetDisplayName() const { return GetDefinition()->ItemDisplayName; }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE FText GetDescription() const { return GetDefinition()->ItemDescription; }
+
+	// may vary with the item's state (i.e., equip/unequip)
+	UFUNCTION(BlueprintPure, Category = "Item")
+	virtual FText GetUseActionText() const;
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE EItemRarity GetRarity() const { return GetDefinition()->Rarity; }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE float GetWeight() const { return GetDefinition()->Weight; }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	virtual bool IsStackable() const;
+
+	// 1 for items that don't stack
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE int32 GetMaxStackSize() const { return IsStackable() ? FMath::Max(GetDefinition()->MaxStackSize, 1) : 1; }
+
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE TSubclassOf<class UItemTooltip> GetTooltipClass() const { return GetDefinition()->ItemTooltip; }
+
 	UFUNCTION(BlueprintCallable, Category = "Item")
-	FORCEINLINE float GetStackWeight() const { return Quantity * Weight; }
+	FORCEINLINE float GetStackWeight() const { return Quantity * GetWeight(); }
 
 	UFUNCTION(BlueprintPure, Category = "Item")
 	virtual bool ShouldShowInInventory() const;
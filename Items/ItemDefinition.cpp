@@ -0,0 +1,20 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "../Items/ItemDefinition.h"
+
+#define LOCTEXT_NAMESPACE "Item"
+
+
+UItemDefinition::UItemDefinition()
+{
+	// set default values (also what an item without a definition falls back to)
+	ItemDisplayName = LOCTEXT("ItemName", "Item");
+	UseActionText = LOCTEXT("ItemUseActionText", "Use");
+	Rarity = EItemRarity::IR_Common;
+	Weight = 0.0f;
+	bStackable = true;
+	MaxStackSize = 2;
+}
+
+#undef LOCTEXT_NAMESPACE
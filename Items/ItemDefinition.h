@@ -0,0 +1,76 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ItemDefinition.generated.h"
+
+UENUM(BlueprintType)
+enum class EItemRarity : uint8
+{
+	IR_Common UMETA(DisplayName = "Common"),
+	IR_Uncommon UMETA(DisplayName = "Uncommon"),
+	IR_Rare UMETA(DisplayName = "Rare"),
+	IR_Legendary UMETA(DisplayName = "Legendary")
+};
+
+/**
+ *  static data shared by every instance of an item type (display text, meshes, weight, stacking); each item class points at one.
+ *  item instances only hold what varies per item (quantity, flags, owner). presentation assets (meshes, textures, audio) are soft
+ *  references, so loading an item class doesn't load them; see UItem::LoadPresentationAssets()
+ */
+UCLASS(BlueprintType)
+class ACTIONRPGPROJECT_API UItemDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UItemDefinition();
+
+	// mesh to display for this item's in-world pickup
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class UStaticMesh> PickupMesh;
+
+	// on-pickup sound
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class USoundBase> PickupSound;
+
+	// thumbnail inventory picture for this item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSoftObjectPtr<class UTexture2D> Thumbnail;
+
+	// inventory display name for this item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText ItemDisplayName;
+
+	// an optional description of the item to display in the inventory
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (MultiLine = true))
+	FText ItemDescription;
+
+	// the verb text for using the item (e.g., equip, eat, etc)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	FText UseActionText;
+
+	// rarity of the item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	EItemRarity Rarity;
+
+	// weight of the item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 0.0))
+	float Weight;
+
+	// whether or not this item can be stacked in the inventory (equippable items never stack)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	bool bStackable;
+
+	// maximum size a stack of these items can be
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item", meta = (ClampMin = 2, EditCondition = bStackable))
+	int32 MaxStackSize;
+
+	// inventory tooltip for this item
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item")
+	TSubclassOf<class UItemTooltip> ItemTooltip;
+
+};
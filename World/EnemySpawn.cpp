@@ -2,9 +2,14 @@
 
 
 #include "../World/EnemySpawn.h"
+#include "../Enemies/CrowdEnemyController.h"
 #include "../Enemies/Enemy.h"
 #include "../Enemies/EnemyController.h"
+#include "../Framework/GameplayDatabase.h"
+#include "../World/EnemySpawnManager.h"
+#include "AIController.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "Engine/AssetManager.h"
 #include "Engine/DataTable.h"
 
 // sets default values
@@ -14,9 +19,17 @@ AEnemySpawn::AEnemySpawn()
 
 	bShouldOverrideDefaultClassSettings = false;
 	bShouldRespawnOnLoad = false;
+	bSpawnPending = false;
+
+	LiveEnemy = nullptr;
+	bAllowDormancy = false;
+	bDormant = false;
 
 	bActiveAI = false;
 	bIsPatroller = false;
+	bSimulatePatrolWhenDistant = true;
+	bUseCrowdAvoidance = false;
+	CrowdControllerClass = ACrowdEnemyController::StaticClass();
 
 	if (EnemyDefaultsDataTable) // enemy subclass defaults (vary per enemy 'type' - archer, swordsman, etc)
 	{ InitializeDefaultsFromDataTable(); }
@@ -91,6 +104,151 @@ void AEnemySpawn::Tick(float DeltaTime)
 }
 
 
+APawn* AEnemySpawn::SpawnEnemy()
+{
+	if (EnemyTypeToSpawn.IsNull() || bSpawnPending)
+	{ return nullptr; }
+
+	if (EnemyTypeToSpawn.Get())
+	{ return SpawnLoadedEnemy(); }
+
+	bSpawnPending = true;
+
+	const FStreamableDelegate OnLoaded = FStreamableDelegate::CreateUObject(this, &AEnemySpawn::OnEnemyTypeLoaded);
+
+	if (AEnemySpawnManager* SpawnManager = AEnemySpawnManager::Get(this))
+	{ SpawnManager->LoadEnemyClass(EnemyTypeToSpawn, OnLoaded); }
+
+	else
+	{ UAssetManager::GetStreamableManager().RequestAsyncLoad(EnemyTypeToSpawn.ToSoftObjectPath(), OnLoaded, FStreamableManager::AsyncLoadHighPriority); }
+
+	return nullptr;
+}
+
+
+void AEnemySpawn::OnEnemyTypeLoaded()
+{
+	bSpawnPending = false;
+	SpawnLoadedEnemy();
+}
+
+
+APawn* AEnemySpawn::SpawnLoadedEnemy()
+{
+	UClass* EnemyClass = EnemyTypeToSpawn.Get();
+
+	if (!EnemyClass)
+	{ return nullptr; }
+
+	// dormant enemies are restored where they were released
+	const FVector SpawnLocation = bDormant ? DormantRecord.Transform.GetLocation() : GetActorLocation();
+	const FRotator SpawnRotation = bDormant ? DormantRecord.Transform.Rotator() : GetActorRotation();
+
+	const FTransform SpawnTransform(SpawnRotation, SpawnLocation);
+
+	// deferred, so the controller class can be chosen before the pawn is possessed
+	APawn* NewEnemy = GetWorld()->SpawnActorDeferred<APawn>(EnemyClass, SpawnTransform, this, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (!NewEnemy)
+	{ return nullptr; }
+
+	// crowd-steered enemies are possessed by the crowd controller directly, rather than swapping out the enemy class's default one
+	if (bUseCrowdAvoidance && CrowdControllerClass && NewEnemy->IsA<AEnemy>())
+	{
+		if (!(NewEnemy->AIControllerClass && NewEnemy->AIControllerClass->IsChildOf(CrowdControllerClass)))
+		{ NewEnemy->AIControllerClass = CrowdControllerClass; }
+	}
+
+	NewEnemy->FinishSpawning(SpawnTransform);
+
+	// possess and start the behavior tree if the enemy class doesn't auto-possess on spawn
+	if (!NewEnemy->GetController())
+	{ NewEnemy->SpawnDefaultController(); }
+
+	if (EnemyBehaviorTree)
+	{
+		if (AAIController* EnemyController = Cast<AAIController>(NewEnemy->GetController()))
+		{ EnemyController->RunBehaviorTree(EnemyBehaviorTree); }
+	}
+
+	InitializeSpawnedEnemy(NewEnemy);
+
+	if (bDormant)
+	{
+		// InitializeSpawnedEnemy applies fresh defaults; restore the captured state over them
+		if (AEnemy* Enemy = Cast<AEnemy>(NewEnemy))
+		{
+			Enemy->Health = DormantRecord.Health;
+			Enemy->DelayedHealthReportingValue = DormantRecord.Health;
+			Enemy->DelayedHealthBarValue = DormantRecord.Health;
+			Enemy->Poise = DormantRecord.Poise;
+			Enemy->CurrentZone = DormantRecord.CurrentZone;
+			Enemy->SetEnemyAwarenessLevel(DormantRecord.AwarenessLevel);
+		}
+
+		bDormant = false;
+	}
+
+	OnEnemySpawned(NewEnemy);
+
+	return NewEnemy;
+}
+
+
+bool AEnemySpawn::CanEnterDormancy() const
+{
+	const AEnemy* Enemy = Cast<AEnemy>(LiveEnemy);
+
+	if (!(bAllowDormancy || UsesPatrolSimulation()) || bDormant || !Enemy || Enemy->IsPendingKill())
+	{ return false; }
+
+	// never pull an enemy out from under an encounter
+	if (Enemy->EnemyAwarenessLevel == EEnemyAwarenessLevel::EMS_Hostile || Enemy->EnemyCombatTarget || Enemy->bAttacking)
+	{ return false; }
+
+	return Enemy->EnemyMovementStatus != EEnemyMovementStatus::EMS_Dead && Enemy->EnemyMovementStatus != EEnemyMovementStatus::EMS_Attacking;
+}
+
+
+bool AEnemySpawn::EnterDormancy()
+{
+	if (!CanEnterDormancy())
+	{ return false; }
+
+	AEnemy* Enemy = Cast<AEnemy>(LiveEnemy);
+
+	DormantRecord.Health = Enemy->Health;
+	DormantRecord.Poise = Enemy->Poise;
+	DormantRecord.Transform = Enemy->GetActorTransform();
+	DormantRecord.AwarenessLevel = Enemy->EnemyAwarenessLevel;
+	DormantRecord.CurrentZone = Enemy->CurrentZone;
+
+	bDormant = true;
+	LiveEnemy = nullptr;
+
+	// the director would otherwise keep coordinating a destroyed enemy (AEnemy::WhenDestroyed is only bound from Blueprint, if at all)
+	if (AssignedAICombatDirector)
+	{ AssignedAICombatDirector->AssignedEnemyList.Remove(Enemy); }
+
+	// takes its controller with it
+	Enemy->Destroy();
+
+	return true;
+}
+
+
+int32 AEnemySpawn::GetOccupiedZone() const
+{
+	if (bDormant)
+	{ return DormantRecord.CurrentZone; }
+
+	if (const AEnemy* Enemy = Cast<AEnemy>(LiveEnemy))
+	{ return Enemy->CurrentZone; }
+
+	return INDEX_NONE;
+}
+
+
 void AEnemySpawn::InitializeSpawnedEnemy(APawn* SpawnedEnemy)
 {
 	if (AssignedAICombatDirector)
@@ -129,13 +287,19 @@ void AEnemySpawn::InitializeSpawnedEnemy(APawn* SpawnedEnemy)
 			// add enemy to its assigned director's enemy list
 			AssignedAICombatDirector->AssignedEnemyList.Add(SpawnedEnemy);
 
+			// spawned into an already-sealed arena
+			if (AssignedAICombatDirector->bArenaSealed)
+			{ AssignedAICombatDirector->SetEnemyEncounterSealed(SpawnedEnemy, true); }
+
 			// set base enemy defaults
 			Enemy->BehaviorType = BehaviorType;
 			Enemy->PrimaryAssignedZone = PrimaryAssignedZone;
+			Enemy->CurrentZone = PrimaryAssignedZone;
 			Enemy->AllowedNeighborZones = AllowedNeighborZones;
 
 			// update tracking variables
 			Enemy->SpawnPoint = this;
+			LiveEnemy = SpawnedEnemy;
 			bHasBeenSpawned = true;
 
 			// set flag (Enemy class sets to false upon death) to respawn this enemy on next game load
@@ -153,7 +317,10 @@ void AEnemySpawn::InitializeSpawnedEnemy(APawn* SpawnedEnemy)
 void AEnemySpawn::InitializeDefaultsFromDataTable()
 {
 	static const FString ContextStringStats = (TEXT("Enemy Stats Data Context"));
-	FEnemyStatDefaults* EnemyStatData = EnemyDefaultsDataTable->FindRow<FEnemyStatDefaults>(FName(TEXT("Defaults")), ContextStringStats, true);
+	// baked database first (no row lookup by name); falls back to the table itself if it wasn't baked
+	FEnemyStatDefaults BakedStatData;
+	FEnemyStatDefaults* EnemyStatData = FGameplayDatabase::Get().FindEnemyStatDefaults(EnemyDefaultsDataTable, FName(TEXT("Defaults")), BakedStatData) ?
+		&BakedStatData : EnemyDefaultsDataTable->FindRow<FEnemyStatDefaults>(FName(TEXT("Defaults")), ContextStringStats, true);
 	if (EnemyStatData && !bShouldOverrideDefaultClassSettings)
 	{
 		MaxHealth = EnemyStatData->MaxHealth;
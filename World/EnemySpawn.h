@@ -10,6 +10,36 @@
 #include "EnemySpawn.generated.h"
 
 
+// gameplay state of a dormant spawn's enemy, captured when its actor was released
+USTRUCT(BlueprintType)
+struct FEnemyDormantRecord
+{
+	GENERATED_BODY()
+
+	FEnemyDormantRecord()
+	{
+		Health = 0.f;
+		Poise = 0.f;
+		AwarenessLevel = EEnemyAwarenessLevel::EMS_Passive;
+		CurrentZone = 0;
+	}
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Health;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Poise;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FTransform Transform;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EEnemyAwarenessLevel AwarenessLevel;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 CurrentZone;
+};
+
 
 UCLASS()
 class ACTIONRPGPROJECT_API AEnemySpawn : public AActor
@@ -29,8 +59,9 @@ public:
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)  override;
 #endif
 
+	// soft reference; streamed in ahead of time by the spawn manager's preloads (or on demand by SpawnEnemy)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Settings")
-	TSubclassOf<class APawn> EnemyTypeToSpawn;
+	TSoftClassPtr<class APawn> EnemyTypeToSpawn;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"), Category = "Spawn Settings")
 	class UDataTable* EnemyDefaultsDataTable;
@@ -62,6 +93,38 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Settings")
 	bool bShouldRespawnOnLoad;
 
+	// the enemy currently spawned from this spawn, if it's alive and not dormant
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Spawn Settings")
+	APawn* LiveEnemy;
+
+	/**
+	 *  dormancy
+	 */
+
+	// if true, the spawn manager may release this spawn's enemy while the player is away from its zone, and restore it on return
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dormancy")
+	bool bAllowDormancy;
+
+	// true while the enemy exists only as DormantRecord (bShouldRespawnOnLoad is left untouched; a dormant enemy is still alive)
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Dormancy")
+	bool bDormant;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Dormancy")
+	FEnemyDormantRecord DormantRecord;
+
+	// true if the live enemy can be released right now (alive, not engaged or otherwise mid-action)
+	bool CanEnterDormancy() const;
+
+	// capture the live enemy into DormantRecord and destroy its actor; returns false if it can't currently go dormant
+	UFUNCTION(BlueprintCallable, Category = "Dormancy")
+	bool EnterDormancy();
+
+	// zone the enemy is in (live or dormant); INDEX_NONE if there's no enemy
+	int32 GetOccupiedZone() const;
+
+	// true if distant patrols are simulated by the spawn manager rather than put through zone dormancy
+	bool UsesPatrolSimulation() const { return bIsPatroller && bSimulatePatrolWhenDistant && PatrolRoutePoints.Num() >= 2; }
+
 	/**
 	 *  enemy AI variable settings
 	 */
@@ -72,6 +135,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI")
 	bool bIsPatroller;
 
+	// patrol waypoints, relative to the spawn; walked in order and looped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI", meta = (MakeEditWidget = true))
+	TArray<FVector> PatrolRoutePoints;
+
+	/* if true (and this is a patroller with a route), the enemy is released while out of the player's perception range and its patrol
+	is advanced by the spawn manager's lightweight simulation instead; it's respawned at its simulated position on approach */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI")
+	bool bSimulatePatrolWhenDistant;
+
+	// if true, the spawned enemy is possessed by CrowdControllerClass and steers via the shared crowd simulation rather than its own RVO avoidance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI")
+	bool bUseCrowdAvoidance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI", meta = (EditCondition = "bUseCrowdAvoidance"))
+	TSubclassOf<class ACrowdEnemyController> CrowdControllerClass;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy AI")
 	float PerceptionRange;
 
@@ -133,11 +212,32 @@ public:
 	// called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	/* spawn (and initialize) this spawn's enemy. if EnemyTypeToSpawn isn't loaded yet, it's async-loaded first and the enemy
+	is spawned once it's resident; the game thread never blocks on the load. returns the enemy if spawned immediately.
+	to spread many spawns across frames, queue them on the spawn manager instead */
+	UFUNCTION(BlueprintCallable)
+	APawn* SpawnEnemy();
+
+	// called once SpawnEnemy's enemy has been spawned and initialized
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnEnemySpawned(APawn* SpawnedEnemy);
+
 	UFUNCTION(BlueprintCallable)
 	void InitializeSpawnedEnemy(APawn* SpawnedEnemy);
 
 	void InitializeDefaultsFromDataTable();
 
+private:
+
+	// true while waiting on EnemyTypeToSpawn to load
+	bool bSpawnPending;
+
+	void OnEnemyTypeLoaded();
+
+	APawn* SpawnLoadedEnemy();
+
+public:
+
 	/**
 	* @param isTearingDown true if world is tearing down.
 	*/UFUNCTION(BluePrintCallable, BlueprintPure, Category = "WorldState", meta = (DisplayName = "IsTearingDown", DefaultToSelf = caller, HidePin = caller))
@@ -0,0 +1,675 @@
+// © 2022 Andrew Creekmore 
+
+
+#include "../World/EnemySpawnManager.h"
+#include "../Enemies/Enemy.h"
+#include "../Enemies/EnemyController.h"
+#include "../World/EnemySpawn.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "Engine/AssetManager.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "NavigationPath.h"
+#include "NavigationSystem.h"
+
+// sets default values
+AEnemySpawnManager::AEnemySpawnManager()
+{
+	// only ticks while spawns are queued
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	SpawnBudgetMs = 2.f;
+
+	DormancyCheckInterval = 1.f;
+	DefaultZoneActivationRadius = 8000.f;
+	DormancyHysteresis = 1000.f;
+
+	PatrolSimulationInterval = 0.25f;
+	SimulatedPatrolSpeed = 150.f;
+	PatrolPromotionMargin = 1000.f;
+}
+
+
+// the manager registered for each world; Get() is called per-enemy, so it shouldn't scan the world's actors
+TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AEnemySpawnManager>> AEnemySpawnManager::RegisteredManagers;
+
+
+AEnemySpawnManager* AEnemySpawnManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World)
+	{ return nullptr; }
+
+	const TWeakObjectPtr<AEnemySpawnManager>* Manager = RegisteredManagers.Find(World);
+	return Manager ? Manager->Get() : nullptr;
+}
+
+
+// registers before any BeginPlay in the level, so enemies placed alongside the manager can find it
+void AEnemySpawnManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	if (UWorld* World = GetWorld())
+	{
+		TWeakObjectPtr<AEnemySpawnManager>& Manager = RegisteredManagers.FindOrAdd(World);
+		if (Manager.IsValid() && Manager.Get() != this)
+		{ UE_LOG(LogTemp, Warning, TEXT("%s: more than one manager placed in %s; only the first is used"), *GetName(), *World->GetName()); }
+
+		else
+		{ Manager = this; }
+	}
+}
+
+
+// called when the game starts or when spawned
+void AEnemySpawnManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildSpawnRegistry();
+
+	if (DormancyCheckInterval > 0.f)
+	{ GetWorldTimerManager().SetTimer(DormancyTimer, this, &AEnemySpawnManager::UpdateZoneDormancy, DormancyCheckInterval, true); }
+
+	BuildPatrolRoutes();
+
+	if (SimulatedPatrols.Num() > 0 && PatrolSimulationInterval > 0.f)
+	{ GetWorldTimerManager().SetTimer(PatrolSimulationTimer, this, &AEnemySpawnManager::StepPatrolSimulation, PatrolSimulationInterval, true); }
+}
+
+
+void AEnemySpawnManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(DormancyTimer);
+	GetWorldTimerManager().ClearTimer(PatrolSimulationTimer);
+
+	SpawnQueue.Empty();
+	ReleasePreloads();
+
+
+	const TWeakObjectPtr<AEnemySpawnManager>* Manager = RegisteredManagers.Find(GetWorld());
+	if (Manager && (!Manager->IsValid() || Manager->Get() == this))
+	{ RegisteredManagers.Remove(GetWorld()); }
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AEnemySpawnManager::BuildSpawnRegistry()
+{
+	RegisteredSpawns.Reset();
+	SpawnRegistryIndices.Reset();
+	CheckpointSpawnIndices.Reset();
+	ZoneSpawnIndices.Reset();
+	ZoneOccupantSpawnIndices.Reset();
+	ZoneCenters.Reset();
+
+	for (TActorIterator<AEnemySpawn> It(GetWorld()); It; ++It)
+	{
+		const int32 SpawnIndex = RegisteredSpawns.Add(*It);
+		SpawnRegistryIndices.Add(*It, SpawnIndex);
+
+		for (const int32 CheckpointKey : It->AssignedCheckpointKeys)
+		{ CheckpointSpawnIndices.FindOrAdd(CheckpointKey).Indices.AddUnique(SpawnIndex); }
+
+		ZoneSpawnIndices.FindOrAdd(It->PrimaryAssignedZone).Indices.Add(SpawnIndex);
+		ZoneOccupantSpawnIndices.FindOrAdd(It->PrimaryAssignedZone).Indices.AddUnique(SpawnIndex);
+
+		for (const int32 NeighborZone : It->AllowedNeighborZones)
+		{ ZoneOccupantSpawnIndices.FindOrAdd(NeighborZone).Indices.AddUnique(SpawnIndex); }
+	}
+
+	// zone centers: average of each zone's spawn locations
+	for (const auto& ZoneSpawns : ZoneSpawnIndices)
+	{
+		FVector ZoneCenter = FVector::ZeroVector;
+
+		for (const int32 SpawnIndex : ZoneSpawns.Value.Indices)
+		{ ZoneCenter += RegisteredSpawns[SpawnIndex]->GetActorLocation(); }
+
+		ZoneCenters.Add(ZoneSpawns.Key, ZoneCenter / float(ZoneSpawns.Value.Indices.Num()));
+	}
+}
+
+
+void AEnemySpawnManager::GatherSpawns(const TMap<int32, FEnemySpawnIndexList>& IndexMap, int32 Key, TArray<AEnemySpawn*>& OutSpawns) const
+{
+	if (const FEnemySpawnIndexList* SpawnIndices = IndexMap.Find(Key))
+	{
+		for (const int32 SpawnIndex : SpawnIndices->Indices)
+		{
+			if (RegisteredSpawns[SpawnIndex])
+			{ OutSpawns.Add(RegisteredSpawns[SpawnIndex]); }
+		}
+	}
+}
+
+
+TArray<AEnemySpawn*> AEnemySpawnManager::GetSpawnsForCheckpoint(int32 CheckpointKey) const
+{
+	TArray<AEnemySpawn*> CheckpointSpawns;
+	GatherSpawns(CheckpointSpawnIndices, CheckpointKey, CheckpointSpawns);
+	return CheckpointSpawns;
+}
+
+
+TArray<AEnemySpawn*> AEnemySpawnManager::GetSpawnsInZone(int32 Zone) const
+{
+	TArray<AEnemySpawn*> ZoneSpawns;
+	GatherSpawns(ZoneSpawnIndices, Zone, ZoneSpawns);
+	return ZoneSpawns;
+}
+
+
+TArray<APawn*> AEnemySpawnManager::GetLiveEnemiesInZone(int32 Zone) const
+{
+	TArray<APawn*> LiveEnemies;
+	TArray<AEnemySpawn*> CandidateSpawns;
+	GatherSpawns(ZoneOccupantSpawnIndices, Zone, CandidateSpawns);
+
+	for (const AEnemySpawn* Spawn : CandidateSpawns)
+	{
+		if (Spawn->LiveEnemy && Spawn->GetOccupiedZone() == Zone)
+		{ LiveEnemies.Add(Spawn->LiveEnemy); }
+	}
+
+	return LiveEnemies;
+}
+
+
+void AEnemySpawnManager::ResetSpawnsForCheckpoint(int32 CheckpointKey)
+{
+	for (AEnemySpawn* Spawn : GetSpawnsForCheckpoint(CheckpointKey))
+	{
+		Spawn->bShouldRespawnOnLoad = true;
+		ResetSpawn(Spawn);
+	}
+}
+
+
+void AEnemySpawnManager::ResetSpawnsForRespawn()
+{
+	// corpses (and their blood pools) wouldn't survive a reload either
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It)
+	{
+		if (It->Alive())
+		{ continue; }
+
+		if (It->SpawnedBloodPool)
+		{ It->SpawnedBloodPool->Destroy(); }
+
+		It->Destroy();
+	}
+
+	for (AEnemySpawn* Spawn : RegisteredSpawns)
+	{
+		if (Spawn && Spawn->bShouldRespawnOnLoad)
+		{ ResetSpawn(Spawn); }
+	}
+
+	// encounters end with the player's death
+	for (TActorIterator<AAICombatDirector> It(GetWorld()); It; ++It)
+	{
+		It->UnsealArena();
+		It->CurrentlyHostileEnemyList.Empty();
+	}
+}
+
+
+void AEnemySpawnManager::ResetSpawn(AEnemySpawn* Spawn)
+{
+	if (Spawn->LiveEnemy)
+	{
+		Spawn->LiveEnemy->Destroy();
+		Spawn->LiveEnemy = nullptr;
+	}
+
+	// dormant state is forgotten; the enemy comes back fresh at the spawn itself
+	Spawn->bDormant = false;
+
+	if (FSimulatedPatrol* Patrol = FindSimulatedPatrol(Spawn))
+	{
+		Patrol->bSimulating = false;
+		Patrol->bPromoting = false;
+	}
+
+	QueueSpawn(Spawn);
+}
+
+
+void AEnemySpawnManager::PreloadForCheckpoint(int32 CheckpointKey)
+{
+	RequestPreload(GetSpawnsForCheckpoint(CheckpointKey));
+}
+
+
+void AEnemySpawnManager::PreloadForZone(int32 Zone, bool bIncludeNeighborZones)
+{
+	TArray<AEnemySpawn*> ZoneSpawns = GetSpawnsInZone(Zone);
+
+	if (bIncludeNeighborZones)
+	{
+		TSet<int32> NeighborZones;
+
+		for (const AEnemySpawn* Spawn : ZoneSpawns)
+		{ NeighborZones.Append(Spawn->AllowedNeighborZones); }
+
+		NeighborZones.Remove(Zone);
+
+		for (const int32 NeighborZone : NeighborZones)
+		{ GatherSpawns(ZoneSpawnIndices, NeighborZone, ZoneSpawns); }
+	}
+
+	RequestPreload(ZoneSpawns);
+}
+
+
+void AEnemySpawnManager::RequestPreload(const TArray<AEnemySpawn*>& Spawns)
+{
+	for (const AEnemySpawn* Spawn : Spawns)
+	{
+		const FSoftObjectPath EnemyClassPath = Spawn->EnemyTypeToSpawn.ToSoftObjectPath();
+
+		if (EnemyClassPath.IsNull() || PreloadHandles.Contains(EnemyClassPath))
+		{ continue; }
+
+		RequestLoad(EnemyClassPath, FStreamableManager::DefaultAsyncLoadPriority);
+	}
+}
+
+
+void AEnemySpawnManager::RequestLoad(const FSoftObjectPath& EnemyClassPath, TAsyncLoadPriority Priority)
+{
+	// loading the class streams in its default object's hard references (montages, sound cues, particles) with it
+	PreloadHandles.Add(EnemyClassPath, UAssetManager::GetStreamableManager().RequestAsyncLoad(EnemyClassPath,
+		FStreamableDelegate::CreateUObject(this, &AEnemySpawnManager::OnEnemyClassLoaded, EnemyClassPath), Priority));
+}
+
+
+void AEnemySpawnManager::LoadEnemyClass(const TSoftClassPtr<APawn>& EnemyClass, FStreamableDelegate OnLoaded)
+{
+	if (EnemyClass.IsNull())
+	{ return; }
+
+	if (EnemyClass.Get())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	const FSoftObjectPath EnemyClassPath = EnemyClass.ToSoftObjectPath();
+	PendingLoadCallbacks.FindOrAdd(EnemyClassPath).Add(OnLoaded);
+
+	// already being (pre)loaded; just wait on it
+	const TSharedPtr<FStreamableHandle>* ExistingHandle = PreloadHandles.Find(EnemyClassPath);
+
+	if (ExistingHandle && ExistingHandle->IsValid() && (*ExistingHandle)->IsLoadingInProgress())
+	{ return; }
+
+	RequestLoad(EnemyClassPath, FStreamableManager::AsyncLoadHighPriority);
+}
+
+
+void AEnemySpawnManager::OnEnemyClassLoaded(FSoftObjectPath EnemyClassPath)
+{
+	TArray<FStreamableDelegate> Callbacks;
+
+	if (PendingLoadCallbacks.RemoveAndCopyValue(EnemyClassPath, Callbacks))
+	{
+		for (const FStreamableDelegate& OnLoaded : Callbacks)
+		{ OnLoaded.ExecuteIfBound(); }
+	}
+}
+
+
+void AEnemySpawnManager::ReleasePreloads()
+{
+	for (auto& PreloadHandle : PreloadHandles)
+	{
+		if (PreloadHandle.Value.IsValid())
+		{ PreloadHandle.Value->ReleaseHandle(); }
+	}
+
+	PreloadHandles.Empty();
+	PendingLoadCallbacks.Empty();
+}
+
+
+bool AEnemySpawnManager::IsPreloadInProgress() const
+{
+	for (const auto& PreloadHandle : PreloadHandles)
+	{
+		if (PreloadHandle.Value.IsValid() && PreloadHandle.Value->IsLoadingInProgress())
+		{ return true; }
+	}
+
+	return false;
+}
+
+
+void AEnemySpawnManager::QueueSpawn(AEnemySpawn* Spawn)
+{
+	if (!Spawn || SpawnQueue.ContainsByPredicate([Spawn](const FQueuedEnemySpawn& QueuedSpawn) { return QueuedSpawn.Spawn.Get() == Spawn; }))
+	{ return; }
+
+	FQueuedEnemySpawn& QueuedSpawn = SpawnQueue.AddDefaulted_GetRef();
+	QueuedSpawn.Spawn = Spawn;
+
+	SetActorTickEnabled(true);
+}
+
+
+void AEnemySpawnManager::QueueSpawnsForCheckpoint(int32 CheckpointKey)
+{
+	for (AEnemySpawn* Spawn : GetSpawnsForCheckpoint(CheckpointKey))
+	{
+		/* spawns whose enemy was killed stay empty until respawned on load; those with a live enemy are already populated. dormant enemies
+		(including simulated patrollers, which go dormant to be simulated) are still alive; UpdateZoneDormancy and the patrol simulation bring them back */
+		if (!Spawn->LiveEnemy && !Spawn->bDormant && (!Spawn->bHasBeenSpawned || Spawn->bShouldRespawnOnLoad))
+		{ QueueSpawn(Spawn); }
+	}
+}
+
+
+// called every frame (only while spawns are queued)
+void AEnemySpawnManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TickSpawnQueue();
+}
+
+
+void AEnemySpawnManager::TickSpawnQueue()
+{
+	SpawnQueue.RemoveAll([](const FQueuedEnemySpawn& QueuedSpawn) { return !QueuedSpawn.Spawn.IsValid(); });
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// nearest the player first
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	SpawnQueue.Sort([&PlayerLocation](const FQueuedEnemySpawn& A, const FQueuedEnemySpawn& B)
+	{ return FVector::DistSquared(A.Spawn->GetActorLocation(), PlayerLocation) < FVector::DistSquared(B.Spawn->GetActorLocation(), PlayerLocation); });
+
+	int32 NumProcessed = 0;
+
+	for (int32 i = 0; i < SpawnQueue.Num();)
+	{
+		if (NumProcessed > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= SpawnBudgetMs)
+		{ break; }
+
+		AEnemySpawn* Spawn = SpawnQueue[i].Spawn.Get();
+
+		// class still streaming in; start (or keep waiting on) its load and move on to the next-nearest spawn
+		if (!Spawn->EnemyTypeToSpawn.IsNull() && !Spawn->EnemyTypeToSpawn.Get())
+		{
+			if (!SpawnQueue[i].bLoadRequested)
+			{
+				SpawnQueue[i].bLoadRequested = true;
+				LoadEnemyClass(Spawn->EnemyTypeToSpawn, FStreamableDelegate());
+			}
+
+			const TSharedPtr<FStreamableHandle>* LoadHandle = PreloadHandles.Find(Spawn->EnemyTypeToSpawn.ToSoftObjectPath());
+
+			// load finished without producing the class (bad reference, etc); report the failure rather than waiting forever
+			if (!LoadHandle || !LoadHandle->IsValid() || !(*LoadHandle)->IsLoadingInProgress())
+			{
+				SpawnQueue.RemoveAt(i, 1, false);
+				OnQueuedSpawnCompleted.Broadcast(Spawn, nullptr);
+				continue;
+			}
+
+			++i;
+			continue;
+		}
+
+		SpawnQueue.RemoveAt(i, 1, false);
+		++NumProcessed;
+
+		APawn* SpawnedEnemy = Spawn->SpawnEnemy();
+
+		if (FSimulatedPatrol* Patrol = FindSimulatedPatrol(Spawn))
+		{ OnPatrollerPromoted(*Patrol, SpawnedEnemy); }
+
+		OnQueuedSpawnCompleted.Broadcast(Spawn, SpawnedEnemy);
+	}
+
+	if (SpawnQueue.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+		OnSpawnQueueDrained.Broadcast();
+	}
+}
+
+
+float AEnemySpawnManager::GetZoneActivationRadius(int32 Zone) const
+{
+	const float* ZoneRadius = ZoneActivationRadii.Find(Zone);
+	return ZoneRadius ? *ZoneRadius : DefaultZoneActivationRadius;
+}
+
+
+void AEnemySpawnManager::UpdateZoneDormancy()
+{
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+
+	if (!PlayerPawn)
+	{ return; }
+
+	const FVector PlayerLocation = PlayerPawn->GetActorLocation();
+
+	for (AEnemySpawn* Spawn : RegisteredSpawns)
+	{
+		// patrollers are handled by the patrol simulation
+		if (!Spawn || !Spawn->bAllowDormancy || Spawn->UsesPatrolSimulation())
+		{ continue; }
+
+		// relocated enemies follow the zone they're in, not the one they spawned in
+		const int32 Zone = Spawn->GetOccupiedZone();
+		const FVector* ZoneCenter = ZoneCenters.Find(Zone);
+
+		if (Zone == INDEX_NONE || !ZoneCenter)
+		{ continue; }
+
+		const float DistanceToZone = FVector::Dist(PlayerLocation, *ZoneCenter);
+		const float ActivationRadius = GetZoneActivationRadius(Zone);
+
+		// player is back in range; rehydrate through the spawn queue
+		if (Spawn->bDormant && DistanceToZone <= ActivationRadius)
+		{ QueueSpawn(Spawn); }
+
+		else if (!Spawn->bDormant && DistanceToZone > ActivationRadius + DormancyHysteresis)
+		{ Spawn->EnterDormancy(); }
+	}
+}
+
+
+void AEnemySpawnManager::BuildPatrolRoutes()
+{
+	SimulatedPatrols.Empty();
+	SpawnPatrolIndices.Init(INDEX_NONE, RegisteredSpawns.Num());
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	for (int32 SpawnIndex = 0; SpawnIndex < RegisteredSpawns.Num(); ++SpawnIndex)
+	{
+		AEnemySpawn* Spawn = RegisteredSpawns[SpawnIndex];
+
+		if (!Spawn || !Spawn->UsesPatrolSimulation())
+		{ continue; }
+
+		SpawnPatrolIndices[SpawnIndex] = SimulatedPatrols.Num();
+
+		FSimulatedPatrol& Patrol = SimulatedPatrols.AddDefaulted_GetRef();
+		Patrol.Spawn = Spawn;
+
+		const FTransform& SpawnTransform = Spawn->GetActorTransform();
+		const int32 NumWaypoints = Spawn->PatrolRoutePoints.Num();
+
+		// expand each (looping) leg into navmesh points, so the simulated position stays where an actor could actually walk
+		for (int32 i = 0; i < NumWaypoints; ++i)
+		{
+			const int32 NextWaypoint = (i + 1) % NumWaypoints;
+			const FVector LegStart = SpawnTransform.TransformPosition(Spawn->PatrolRoutePoints[i]);
+			const FVector LegEnd = SpawnTransform.TransformPosition(Spawn->PatrolRoutePoints[NextWaypoint]);
+
+			UNavigationPath* LegPath = NavSys ? UNavigationSystemV1::FindPathToLocationSynchronously(GetWorld(), LegStart, LegEnd) : nullptr;
+
+			if (LegPath && LegPath->IsValid() && LegPath->PathPoints.Num() > 1)
+			{
+				// last point of each leg is the first of the next
+				for (int32 j = 0; j < LegPath->PathPoints.Num() - 1; ++j)
+				{
+					Patrol.RoutePoints.Add(LegPath->PathPoints[j]);
+					Patrol.RouteWaypointIndices.Add(NextWaypoint);
+				}
+			}
+
+			// no navmesh path; walk the straight line
+			else
+			{
+				Patrol.RoutePoints.Add(LegStart);
+				Patrol.RouteWaypointIndices.Add(NextWaypoint);
+			}
+		}
+
+		Patrol.Location = Patrol.RoutePoints[0];
+	}
+}
+
+
+FSimulatedPatrol* AEnemySpawnManager::FindSimulatedPatrol(const AEnemySpawn* Spawn)
+{
+	const int32* SpawnIndex = SpawnRegistryIndices.Find(Spawn);
+	const int32 PatrolIndex = (SpawnIndex && SpawnPatrolIndices.IsValidIndex(*SpawnIndex)) ? SpawnPatrolIndices[*SpawnIndex] : INDEX_NONE;
+
+	return PatrolIndex != INDEX_NONE ? &SimulatedPatrols[PatrolIndex] : nullptr;
+}
+
+
+int32 AEnemySpawnManager::GetNumSimulatedPatrols() const
+{
+	int32 NumSimulating = 0;
+
+	for (const FSimulatedPatrol& Patrol : SimulatedPatrols)
+	{
+		if (Patrol.bSimulating)
+		{ ++NumSimulating; }
+	}
+
+	return NumSimulating;
+}
+
+
+void AEnemySpawnManager::StepPatrolSimulation()
+{
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+
+	if (!PlayerPawn)
+	{ return; }
+
+	const FVector PlayerLocation = PlayerPawn->GetActorLocation();
+
+	for (FSimulatedPatrol& Patrol : SimulatedPatrols)
+	{
+		AEnemySpawn* Spawn = Patrol.Spawn.Get();
+
+		if (!Spawn || Patrol.bPromoting)
+		{ continue; }
+
+		const float PromotionRadius = Spawn->PerceptionRange + PatrolPromotionMargin;
+
+		if (Patrol.bSimulating)
+		{
+			AdvanceSimulatedPatrol(Patrol, SimulatedPatrolSpeed * PatrolSimulationInterval);
+
+			// about to come within perception range; respawn as a full enemy at the simulated position
+			if (FVector::DistSquared(Patrol.Location, PlayerLocation) <= FMath::Square(PromotionRadius))
+			{
+				const FVector Heading = Patrol.RoutePoints[(Patrol.RouteIndex + 1) % Patrol.RoutePoints.Num()] - Patrol.Location;
+
+				Spawn->DormantRecord.Transform = FTransform(FRotator(0.f, Heading.Rotation().Yaw, 0.f), Patrol.Location);
+				Patrol.bSimulating = false;
+				Patrol.bPromoting = true;
+
+				QueueSpawn(Spawn);
+			}
+		}
+
+		// live patroller well out of range; release it and pick up its patrol from where it's standing
+		else if (Spawn->LiveEnemy && FVector::DistSquared(Spawn->LiveEnemy->GetActorLocation(), PlayerLocation) > FMath::Square(PromotionRadius + DormancyHysteresis))
+		{
+			const FVector EnemyLocation = Spawn->LiveEnemy->GetActorLocation();
+
+			if (!Spawn->EnterDormancy())
+			{ continue; }
+
+			float ClosestDistSq = MAX_FLT;
+
+			for (int32 i = 0; i < Patrol.RoutePoints.Num(); ++i)
+			{
+				const float DistSq = FVector::DistSquared(EnemyLocation, Patrol.RoutePoints[i]);
+				if (DistSq < ClosestDistSq)
+				{
+					ClosestDistSq = DistSq;
+					Patrol.RouteIndex = i;
+				}
+			}
+
+			Patrol.Location = Patrol.RoutePoints[Patrol.RouteIndex];
+			Patrol.bSimulating = true;
+		}
+	}
+}
+
+
+void AEnemySpawnManager::AdvanceSimulatedPatrol(FSimulatedPatrol& Patrol, float Distance) const
+{
+	const int32 NumRoutePoints = Patrol.RoutePoints.Num();
+
+	while (Distance > 0.f && NumRoutePoints > 1)
+	{
+		const FVector& Target = Patrol.RoutePoints[(Patrol.RouteIndex + 1) % NumRoutePoints];
+		const float DistanceToTarget = FVector::Dist(Patrol.Location, Target);
+
+		if (DistanceToTarget > Distance)
+		{
+			Patrol.Location += (Target - Patrol.Location) / DistanceToTarget * Distance;
+			return;
+		}
+
+		// reached the next route point; carry the remainder into the following segment
+		Patrol.Location = Target;
+		Patrol.RouteIndex = (Patrol.RouteIndex + 1) % NumRoutePoints;
+		Distance -= DistanceToTarget;
+	}
+}
+
+
+void AEnemySpawnManager::OnPatrollerPromoted(FSimulatedPatrol& Patrol, APawn* SpawnedEnemy)
+{
+	if (!Patrol.bPromoting)
+	{ return; }
+
+	Patrol.bPromoting = false;
+
+	// couldn't be spawned; keep simulating (and retry on the next approach)
+	if (!SpawnedEnemy)
+	{
+		Patrol.bSimulating = true;
+		return;
+	}
+
+	AEnemyController* EnemyController = Cast<AEnemyController>(SpawnedEnemy->GetController());
+	UBlackboardComponent* Blackboard = EnemyController ? EnemyController->GetBlackboardComponent() : nullptr;
+
+	// only if the patrol logic tracks its waypoint on the blackboard
+	static const FName PatrolPointIndexKey(TEXT("PatrolPointIndex"));
+
+	if (Blackboard && Blackboard->GetKeyID(PatrolPointIndexKey) != FBlackboard::InvalidKey)
+	{ Blackboard->SetValueAsInt(PatrolPointIndexKey, Patrol.RouteWaypointIndices[Patrol.RouteIndex]); }
+}
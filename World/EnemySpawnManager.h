@@ -0,0 +1,307 @@
+// © 2022 Andrew Creekmore 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/Actor.h"
+#include "EnemySpawnManager.generated.h"
+
+class AEnemySpawn;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnQueuedSpawnCompleted, AEnemySpawn*, Spawn, APawn*, SpawnedEnemy);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSpawnQueueDrained);
+
+// a spawn waiting on the spawn queue's frame budget
+USTRUCT()
+struct FQueuedEnemySpawn
+{
+	GENERATED_BODY()
+
+	FQueuedEnemySpawn()
+	{
+		bLoadRequested = false;
+	}
+
+	UPROPERTY()
+	TWeakObjectPtr<AEnemySpawn> Spawn;
+
+	// enemy class wasn't resident when first reached; skipped until it is
+	bool bLoadRequested;
+};
+
+
+// indices into the spawn registry (USTRUCT wrapper, since UPROPERTY maps can't hold arrays directly)
+USTRUCT()
+struct FEnemySpawnIndexList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<int32> Indices;
+};
+
+
+// a distant patroller advanced without an actor
+USTRUCT()
+struct FSimulatedPatrol
+{
+	GENERATED_BODY()
+
+	FSimulatedPatrol()
+	{
+		RouteIndex = 0;
+		Location = FVector::ZeroVector;
+		bSimulating = false;
+		bPromoting = false;
+	}
+
+	UPROPERTY()
+	TWeakObjectPtr<AEnemySpawn> Spawn;
+
+	// the spawn's waypoints expanded into a looping navmesh polyline, built once
+	UPROPERTY()
+	TArray<FVector> RoutePoints;
+
+	// for each route point, the index of the waypoint its leg is heading to
+	UPROPERTY()
+	TArray<int32> RouteWaypointIndices;
+
+	// start of the route segment currently being walked
+	int32 RouteIndex;
+
+	FVector Location;
+
+	// true while the patroller exists only as this struct
+	bool bSimulating;
+
+	// queued for respawn at Location
+	bool bPromoting;
+};
+
+
+/**
+ *  per-level enemy spawn services; place one in each level containing enemy spawns
+ */
+UCLASS()
+class ACTIONRPGPROJECT_API AEnemySpawnManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	// sets default values for this actor's properties
+	AEnemySpawnManager();
+
+	// returns the spawn manager placed in the given object's world, if there is one
+	static AEnemySpawnManager* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  spawn registry
+	 */
+
+	// (re)build the registry from the level's spawns; done once on BeginPlay
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	void BuildSpawnRegistry();
+
+	/* reset every spawn assigned to this checkpoint (e.g., on rest): live enemies are cleared, dormant and simulated ones forgotten, and
+	all are respawned at full health through the spawn queue. only the affected spawns are touched */
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	void ResetSpawnsForCheckpoint(int32 CheckpointKey);
+
+	/* in-place equivalent of reloading the level: every spawn flagged bShouldRespawnOnLoad is reset and respawned, and corpses
+	(with their blood pools) are cleared */
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	void ResetSpawnsForRespawn();
+
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	TArray<AEnemySpawn*> GetSpawnsForCheckpoint(int32 CheckpointKey) const;
+
+	// spawns whose PrimaryAssignedZone is this zone
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	TArray<AEnemySpawn*> GetSpawnsInZone(int32 Zone) const;
+
+	// live (spawned, alive, not dormant) enemies currently in this zone, including ones relocated there from neighboring zones
+	UFUNCTION(BlueprintCallable, Category = "Spawn Registry")
+	TArray<APawn*> GetLiveEnemiesInZone(int32 Zone) const;
+
+	/**
+	 *  asset preloading
+	 */
+
+	/* asynchronously stream in the enemy classes (along with the montages, sounds and FX they reference) for every spawn assigned to
+	this checkpoint. loaded classes stay resident until released, so the first spawn of each type never blocks on loading */
+	UFUNCTION(BlueprintCallable, Category = "Spawn Preloading")
+	void PreloadForCheckpoint(int32 CheckpointKey);
+
+	// as above, for every spawn in this zone (and, optionally, the zones its spawns may relocate to)
+	UFUNCTION(BlueprintCallable, Category = "Spawn Preloading")
+	void PreloadForZone(int32 Zone, bool bIncludeNeighborZones = true);
+
+	// let the GC reclaim every preloaded enemy class not currently in use
+	UFUNCTION(BlueprintCallable, Category = "Spawn Preloading")
+	void ReleasePreloads();
+
+	UFUNCTION(BlueprintPure, Category = "Spawn Preloading")
+	bool IsPreloadInProgress() const;
+
+	/* async-load a single enemy class at high priority (e.g., a spawn whose type wasn't preloaded); OnLoaded is executed once it's resident.
+	executes immediately if already loaded */
+	void LoadEnemyClass(const TSoftClassPtr<APawn>& EnemyClass, FStreamableDelegate OnLoaded);
+
+	/**
+	 *  spawn queue
+	 */
+
+	// time (in milliseconds) per frame the queue may spend spawning and initializing enemies; at least one spawn is processed per frame regardless
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Queue")
+	float SpawnBudgetMs;
+
+	// fired for each queued spawn as it's processed (SpawnedEnemy is null if spawning failed)
+	UPROPERTY(BlueprintAssignable, Category = "Spawn Queue")
+	FOnQueuedSpawnCompleted OnQueuedSpawnCompleted;
+
+	// fired once every queued spawn has been processed; loading screens and encounters can wait on this
+	UPROPERTY(BlueprintAssignable, Category = "Spawn Queue")
+	FOnSpawnQueueDrained OnSpawnQueueDrained;
+
+	// queue a spawn to be processed under the per-frame budget, nearest the player first (ignored if already queued)
+	UFUNCTION(BlueprintCallable, Category = "Spawn Queue")
+	void QueueSpawn(AEnemySpawn* Spawn);
+
+	// queue every spawn assigned to this checkpoint that should currently be populated
+	UFUNCTION(BlueprintCallable, Category = "Spawn Queue")
+	void QueueSpawnsForCheckpoint(int32 CheckpointKey);
+
+	UFUNCTION(BlueprintPure, Category = "Spawn Queue")
+	int32 GetNumQueuedSpawns() const { return SpawnQueue.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Spawn Queue")
+	bool IsSpawnQueueEmpty() const { return SpawnQueue.Num() == 0; }
+
+	// called every frame (only while spawns are queued)
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 *  zone dormancy
+	 */
+
+	// how often (in seconds) zones are checked against the player's position; 0 disables dormancy
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dormancy")
+	float DormancyCheckInterval;
+
+	// distance from a zone's center within which its enemies are kept live, unless overridden in ZoneActivationRadii
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dormancy")
+	float DefaultZoneActivationRadius;
+
+	// per-zone overrides of DefaultZoneActivationRadius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dormancy")
+	TMap<int32, float> ZoneActivationRadii;
+
+	// extra distance beyond the activation radius before a zone goes dormant, so enemies don't thrash at the boundary
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dormancy")
+	float DormancyHysteresis;
+
+	// release or restore dormancy-enabled enemies based on the player's distance to their zones
+	UFUNCTION(BlueprintCallable, Category = "Dormancy")
+	void UpdateZoneDormancy();
+
+	/**
+	 *  patrol simulation
+	 */
+
+	// fixed step (in seconds) at which simulated patrols advance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Patrol Simulation")
+	float PatrolSimulationInterval;
+
+	// walk speed of simulated patrols
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Patrol Simulation")
+	float SimulatedPatrolSpeed;
+
+	// patrollers are promoted to actors within their spawn's PerceptionRange plus this margin, and released beyond that plus DormancyHysteresis
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Patrol Simulation")
+	float PatrolPromotionMargin;
+
+	UFUNCTION(BlueprintPure, Category = "Patrol Simulation")
+	int32 GetNumSimulatedPatrols() const;
+
+protected:
+
+	// called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void PostInitializeComponents() override;
+
+	// per-world registration backing Get()
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AEnemySpawnManager>> RegisteredManagers;
+
+	// every spawn in the level; the registry's index lists point into this
+	UPROPERTY(VisibleInstanceOnly, Category = "Spawn Registry")
+	TArray<AEnemySpawn*> RegisteredSpawns;
+
+	// each registered spawn's index in RegisteredSpawns
+	TMap<const AEnemySpawn*, int32> SpawnRegistryIndices;
+
+	UPROPERTY()
+	TMap<int32, FEnemySpawnIndexList> CheckpointSpawnIndices;
+
+	// by PrimaryAssignedZone
+	UPROPERTY()
+	TMap<int32, FEnemySpawnIndexList> ZoneSpawnIndices;
+
+	// by every zone a spawn's enemy may occupy (primary and allowed neighbors)
+	UPROPERTY()
+	TMap<int32, FEnemySpawnIndexList> ZoneOccupantSpawnIndices;
+
+	// clear the spawn's enemy (live, dormant or simulated) and queue a fresh one
+	void ResetSpawn(AEnemySpawn* Spawn);
+
+	void GatherSpawns(const TMap<int32, FEnemySpawnIndexList>& IndexMap, int32 Key, TArray<AEnemySpawn*>& OutSpawns) const;
+
+	// one handle per requested class; holding it keeps the class resident
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+	// callbacks waiting on a class that's still loading
+	TMap<FSoftObjectPath, TArray<FStreamableDelegate>> PendingLoadCallbacks;
+
+	void RequestPreload(const TArray<AEnemySpawn*>& Spawns);
+
+	void RequestLoad(const FSoftObjectPath& EnemyClassPath, TAsyncLoadPriority Priority);
+
+	void OnEnemyClassLoaded(FSoftObjectPath EnemyClassPath);
+
+	UPROPERTY()
+	TArray<FQueuedEnemySpawn> SpawnQueue;
+
+	void TickSpawnQueue();
+
+	// average of each zone's spawn locations
+	UPROPERTY(VisibleInstanceOnly, Category = "Dormancy")
+	TMap<int32, FVector> ZoneCenters;
+
+	FTimerHandle DormancyTimer;
+
+	float GetZoneActivationRadius(int32 Zone) const;
+
+	UPROPERTY()
+	TArray<FSimulatedPatrol> SimulatedPatrols;
+
+	// parallel to RegisteredSpawns: each spawn's index in SimulatedPatrols (INDEX_NONE if it isn't simulated)
+	TArray<int32> SpawnPatrolIndices;
+
+	// the spawn's simulated patrol, if it has one
+	FSimulatedPatrol* FindSimulatedPatrol(const AEnemySpawn* Spawn);
+
+	FTimerHandle PatrolSimulationTimer;
+
+	void BuildPatrolRoutes();
+
+	void StepPatrolSimulation();
+
+	void AdvanceSimulatedPatrol(FSimulatedPatrol& Patrol, float Distance) const;
+
+	// a queued patroller has been respawned; point its patrol logic at the waypoint it was heading to
+	void OnPatrollerPromoted(FSimulatedPatrol& Patrol, APawn* SpawnedEnemy);
+};
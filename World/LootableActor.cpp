@@ -4,6 +4,7 @@
 #include "../World/LootableActor.h"
 #include "../Components/InteractionComponent.h"
 #include "../Components/InventoryComponent.h"
+#include "../Framework/GameplayDatabase.h"
 #include "../Items/Item.h"
 #include "../World/ItemSpawn.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -41,8 +42,45 @@ void ALootableActor::BeginPlay()
 	Super::BeginPlay();
 	
 	LootInteraction->OnInteract.AddDynamic(this, &ALootableActor::OnInteract);
+	LootInteraction->OnBeginFocus.AddDynamic(this, &ALootableActor::OnBeginFocus);
+	LootInteraction->OnEndFocus.AddDynamic(this, &ALootableActor::OnEndFocus);
 
-	if (LootTable)
+	const FGameplayDatabase& GameplayDatabase = FGameplayDatabase::Get();
+
+	// rolled items are added in one batch, so the inventory is validated and notified once
+	TArray<FItemBatchEntry> RolledItems;
+
+	// baked loot table, if there is one (same rolls, read straight from the gameplay database)
+	if (const FBakedLootTable* BakedLootTable = GameplayDatabase.FindLootTable(LootTable))
+	{
+		int32 Rolls = BakedLootTable->NumRows > 0 ? FMath::RandRange(LootRolls.GetMin(), LootRolls.GetMax()) : 0;
+
+		for (int32 i = 0; i < Rolls; ++i)
+		{
+			const FBakedLootRow* LootRow = &GameplayDatabase.GetLootRow(*BakedLootTable, FMath::RandRange(0, BakedLootTable->NumRows - 1));
+
+			// generate random number
+			float ProbabilityRoll = FMath::FRandRange(0.0f, 1.0f);
+
+			// check if number is within probability range
+			while (ProbabilityRoll > LootRow->Probability)
+			{
+				LootRow = &GameplayDatabase.GetLootRow(*BakedLootTable, FMath::RandRange(0, BakedLootTable->NumRows - 1));
+				ProbabilityRoll = FMath::FRandRange(0.0f, 1.0f);
+			}
+
+			// get and spawn items
+			for (uint32 ItemIndex = 0; ItemIndex < LootRow->NumItems; ++ItemIndex)
+			{
+				const FBakedLootItem& LootItem = GameplayDatabase.GetLootItem(*LootRow, ItemIndex);
+
+				if (TSubclassOf<UItem> ItemClass = GameplayDatabase.ResolveLootItemClass(LootItem))
+				{ RolledItems.Emplace(ItemClass, LootItem.DefaultQuantity); }
+			}
+		}
+	}
+
+	else if (LootTable)
 	{
 		TArray<FLootTableRow*> SpawnItems;
 		LootTable->GetAllRows("", SpawnItems);
@@ -71,14 +109,27 @@ void ALootableActor::BeginPlay()
 				for (auto& ItemClass : LootRow->Items)
 				{
 					if (ItemClass)
-					{
-						const int32 Quantity = Cast<UItem>(ItemClass->GetDefaultObject())->GetQuantity();
-						Inventory->TryAddItemFromClass(ItemClass, Quantity);
-					}
+					{ RolledItems.Emplace(ItemClass, ItemClass->GetDefaultObject<UItem>()->GetQuantity()); }
 				}
 			}
 		}
 	}
+
+	if (RolledItems.Num())
+	{ Inventory->TryAddItemsBatch(RolledItems); }
+}
+
+
+void ALootableActor::OnBeginFocus(class AMain* Character)
+{
+	Inventory->PrefetchPresentationAssets();
+}
+
+
+void ALootableActor::OnEndFocus(class AMain* Character)
+{
+	// anything being shown by then (i.e., loot menu thumbnails) is held by the widgets showing it
+	Inventory->ReleasePresentationAssets();
 }
 
 
@@ -45,4 +45,11 @@ protected:
 	// called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// the contents' presentation assets are prefetched while the chest is focused
+	UFUNCTION()
+	void OnBeginFocus(class AMain* Character);
+
+	UFUNCTION()
+	void OnEndFocus(class AMain* Character);
+
 };
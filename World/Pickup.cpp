@@ -2,6 +2,7 @@
 
 
 #include "../World/Pickup.h"
+#include "Engine/AssetManager.h"
 
 // sets default values
 APickup::APickup()
@@ -17,18 +18,38 @@ APickup::APickup()
 	InteractionComponent->InteractableNameText = FText::FromString("Pickup");
 	InteractionComponent->InteractableActionText = FText::FromString("Take");
 	InteractionComponent->OnInteract.AddDynamic(this, &APickup::OnTakePickup);
+	InteractionComponent->OnBeginFocus.AddDynamic(this, &APickup::OnBeginFocus);
 	InteractionComponent->SetupAttachment(PickupMesh);
 
 	PickupID = MakeUniqueObjectName(GetOuter(), GetClass());
+	Quantity = 0;
+	Item_DEPRECATED = nullptr;
 }
 
 
-void APickup::InitializePickup(const TSubclassOf<class UItem> ItemClass, const int32 Quantity)
+void APickup::PostLoad()
 {
-	if (ItemClass && Quantity > 0)
+	Super::PostLoad();
+
+	// an item saved on a pickup from before pickups held their item by class becomes its template (and is initialized from it on BeginPlay)
+	if (Item_DEPRECATED)
+	{
+		if (!ItemTemplate)
+		{ ItemTemplate = DuplicateObject<UItem>(Item_DEPRECATED, this); }
+
+		Item_DEPRECATED = nullptr;
+	}
+}
+
+
+void APickup::InitializePickup(const TSubclassOf<class UItem> InItemClass, const int32 InQuantity)
+{
+	if (InItemClass && InQuantity > 0)
 	{
-		Item = NewObject<UItem>(this, ItemClass);
-		Item->SetQuantity(Quantity);
+		const UItem* ItemDefaults = InItemClass->GetDefaultObject<UItem>();
+
+		ItemClass = InItemClass;
+		Quantity = FMath::Clamp(InQuantity, 1, ItemDefaults->GetMaxStackSize());
 
 		OnRep_Item();
 	}
@@ -51,24 +72,41 @@ void APickup::BeginPlay()
 
 void APickup::OnRep_Item()
 {
-	if (Item)
+	if (const UItem* ItemDefaults = ItemClass ? ItemClass->GetDefaultObject<UItem>() : nullptr)
 	{
-		PickupMesh->SetStaticMesh(Item->PickupMesh);
-		InteractionComponent->InteractableNameText = Item->ItemDisplayName;
+		const TSoftObjectPtr<UStaticMesh>& ItemPickupMesh = ItemDefaults->GetDefinition()->PickupMesh;
 
-		// bind to this delegate in order to refresh the interaction widget if item quantity changes
-		Item->OnItemModified.AddDynamic(this, &APickup::OnItemModified);
+		// shown as soon as it has streamed in
+		if (ItemPickupMesh.IsNull() || ItemPickupMesh.Get())
+		{ PickupMesh->SetStaticMesh(ItemPickupMesh.Get()); }
+
+		else
+		{ PickupMeshHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ItemPickupMesh.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &APickup::OnPickupMeshLoaded)); }
+
+		InteractionComponent->InteractableNameText = ItemDefaults->GetDisplayName();
 	}
 
-	// if any properties of the item are changed, refresh the widget
+	// if the item or its quantity changed, refresh the widget
 	InteractionComponent->RefreshWidget();
 }
 
 
-void APickup::OnItemModified()
+void APickup::OnPickupMeshLoaded()
 {
-	if (InteractionComponent)
-	{ InteractionComponent->RefreshWidget(); }
+	// the item may have changed while loading
+	if (const UItem* ItemDefaults = ItemClass ? ItemClass->GetDefaultObject<UItem>() : nullptr)
+	{
+		if (UStaticMesh* LoadedPickupMesh = ItemDefaults->GetPickupMesh())
+		{ PickupMesh->SetStaticMesh(LoadedPickupMesh); }
+	}
+}
+
+
+void APickup::OnBeginFocus(class AMain* Character)
+{
+	// so the thumbnail, pickup sound, etc are ready by the time the item is taken
+	if (ItemClass && !ItemAssetsHandle.IsValid())
+	{ ItemAssetsHandle = UItem::LoadPresentationAssets({ ItemClass->GetDefaultObject<UItem>() }); }
 }
 
 
@@ -83,7 +121,7 @@ void APickup::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent
 	if (PropertyName == GET_MEMBER_NAME_CHECKED(APickup, ItemTemplate))
 	{
 		if (ItemTemplate)
-		{ PickupMesh->SetStaticMesh(ItemTemplate->PickupMesh); }
+		{ PickupMesh->SetStaticMesh(ItemTemplate->GetDefinition()->PickupMesh.LoadSynchronous()); }
 	}
 }
 #endif
@@ -97,16 +135,19 @@ void APickup::OnTakePickup(class AMain* Taker)
 		return;
 	}
 
-	if (Item)
+	if (ItemClass && Quantity > 0)
 	{
 		if (UInventoryComponent* PlayerInventory = Taker->PlayerInventory)
 		{
-			const FItemAddResult AddResult = PlayerInventory->TryAddItem(Item);
+			const FItemAddResult AddResult = PlayerInventory->TryAddItemFromClass(ItemClass, Quantity);
 
-			if (AddResult.ActualAmountGiven < Item->GetQuantity())
-			{ Item->SetQuantity(Item->GetQuantity() - AddResult.ActualAmountGiven); }
+			if (AddResult.ActualAmountGiven < Quantity)
+			{
+				Quantity -= FMath::Max(AddResult.ActualAmountGiven, 0);
+				OnRep_Item();
+			}
 
-			else if (AddResult.ActualAmountGiven >= Item->GetQuantity())
+			else if (AddResult.ActualAmountGiven >= Quantity)
 			{ Destroy(); }
 
 			// record pickup ID so we know whether to spawn pickup in world on save game load
@@ -26,7 +26,7 @@ public:
 	FName PickupID;
 
 	// takes the item to represent and creates the pickup from it. performed on BeginPlay and when a player drops an item on the ground
-	void InitializePickup(const TSubclassOf<class UItem> ItemClass, const int32 Quantity);
+	void InitializePickup(const TSubclassOf<class UItem> InItemClass, const int32 InQuantity);
 
 	// aligns pickup's rotation with ground's rotation
 	UFUNCTION(BlueprintImplementableEvent)
@@ -41,16 +41,34 @@ protected:
 	// called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// the item that will be added to the inventory when this pickup is taken
-	UPROPERTY(BlueprintReadWrite, VisibleAnywhere)
-	class UItem* Item;
+	// the item class that will be added to the inventory when this pickup is taken (held by value; a pickup creates no item object)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	TSubclassOf<class UItem> ItemClass;
 
+	// how much of the item is left to take
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 Quantity;
+
+	// pickups used to hold an item object; anything saved in it is moved to ItemTemplate on load
+	UPROPERTY(BlueprintReadWrite, meta = (DeprecatedProperty, DeprecationMessage = "Pickups no longer hold an item object; use ItemClass and Quantity"))
+	class UItem* Item_DEPRECATED;
+
+	virtual void PostLoad() override;
+
+	// refreshes the mesh and interaction UI from ItemClass/Quantity
 	UFUNCTION()
 	void OnRep_Item();
 
-	// if some property of the item is modified, we bind this to OnItemModified and refresh the UI
+	// the item's pickup mesh is a soft reference; it's loaded (and kept loaded by this handle) when the pickup is initialized
+	TSharedPtr<FStreamableHandle> PickupMeshHandle;
+
+	void OnPickupMeshLoaded();
+
+	// the item's other presentation assets (thumbnail, pickup sound, gear meshes), prefetched once the player is in interaction range
+	TSharedPtr<FStreamableHandle> ItemAssetsHandle;
+
 	UFUNCTION()
-	void OnItemModified();
+	void OnBeginFocus(class AMain* Character);
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;